@@ -0,0 +1,121 @@
+#include "Audio.h"
+
+#include <algorithm>
+
+#include "Packer.h"
+
+Audio::Audio(Bundle const& assets)
+	: device(irrklang::createIrrKlangDevice(irrklang::ESOD_AUTO_DETECT, irrklang::ESEO_DEFAULT_OPTIONS & ~irrklang::ESEO_MULTI_THREADED))
+{
+	if (!device)
+		return;
+
+	//Effects are decoded in the bundle and stay in memory, the soundtrack is decoded while it plays
+	for (std::size_t k = 0; k < SOUNDS_END; ++k)
+	{
+		auto const& resource = Packer::SOUNDS[k];
+		auto const* sound = assets.find(resource.name);
+		if (!sound)
+			continue;
+
+		auto* source = device->addSoundSourceFromMemory((void*)assets.getData(*sound), (irrklang::ik_s32)sound->size, resource.name, false);
+		if (!source)
+			continue;
+
+		source->setStreamMode(resource.decode ? irrklang::ESM_NO_STREAMING : irrklang::ESM_STREAMING);
+		source->setDefaultVolume(SETTINGS[k].volume);
+		sources[k] = source;
+	}
+
+	//The device is touched by the mixer thread only from now on
+	mixer = std::thread(&Audio::mix, this);
+}
+
+Audio::~Audio()
+{
+	if (!device)
+		return;
+
+	running = false;
+	mixer.join();
+
+	std::ranges::for_each(voices, release);
+	if (music)
+	{
+		music->stop();
+		music->drop();
+	}
+	device->drop();
+}
+
+void Audio::mix()
+{
+	while (running)
+	{
+		Sound sound;
+		while (commands.pop(sound))
+			this->start(sound);
+
+		device->update();
+		std::this_thread::sleep_for(MIX_PERIOD);
+	}
+}
+
+void Audio::start(Sound sound)
+{
+	auto* source = sources[sound];
+	if (!source)
+		return;
+
+	if (sound == SOUNDTRACK)
+	{
+		if (!music)
+			music = device->play2D(source, true, false, true);
+		return;
+	}
+
+	auto& voice = takeVoice(sound);
+	voice.sound = device->play2D(source, false, false, true);
+	voice.type = sound;
+	voice.started = ++started;
+}
+
+//A finished voice, the oldest one of the sound if it has all of its voices, or else the oldest one at all
+Audio::Voice& Audio::takeVoice(Sound sound)
+{
+	for (auto& voice : voices)
+		if (voice.sound && voice.sound->isFinished())
+			release(voice);
+
+	auto older = [](Voice const& a, Voice const& b) { return a.started < b.started; };
+
+	Voice* oldest = nullptr;
+	std::uint32_t playing = 0;
+	for (auto& voice : voices)
+	{
+		if (!voice.sound || voice.type != sound)
+			continue;
+		if (!oldest || older(voice, *oldest))
+			oldest = &voice;
+		++playing;
+	}
+
+	if (playing < SETTINGS[sound].voices)
+	{
+		auto free = std::ranges::find(voices, nullptr, &Voice::sound);
+		oldest = free != voices.end() ? &*free : &*std::ranges::min_element(voices, older);
+	}
+
+	release(*oldest);
+	return *oldest;
+}
+
+void Audio::release(Voice& voice)
+{
+	if (!voice.sound)
+		return;
+
+	voice.sound->stop();
+	voice.sound->drop();
+	voice.sound = nullptr;
+}
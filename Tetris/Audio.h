@@ -0,0 +1,84 @@
+#pragma once
+#include <irrKlang.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+
+#include "Bundle.h"
+#include "SpscQueue.hpp"
+
+//The only sound device of the game. irrKlang runs single-threaded and is driven by the mixer thread alone,
+//the game thread only pushes commands into a lock-free queue, so playing a sound never waits for the device.
+//Effects are held as PCM in the bundle and play on a fixed pool of voices, the soundtrack is streamed
+class Audio
+{
+public:
+	//In the order of Packer::SOUNDS
+	enum Sound : std::uint8_t
+	{
+		SOUNDTRACK,
+		LINE_CLEAR,
+		GAME_OVER,
+		FALL,
+		ROTATE,
+		MOVE,
+		SOUNDS_END
+	};
+
+	static constexpr std::size_t MAX_VOICES = 8;	//Effects playing at once, the oldest one is cut for a new one
+	static constexpr std::chrono::milliseconds MIX_PERIOD{ 5 };
+
+private:
+	struct Settings {
+		float volume;
+		std::uint32_t voices;	//Of this sound at once, a new one restarts the oldest
+	};
+
+	//In the order of Sound, the soundtrack has its own voice
+	static constexpr std::array<Settings, SOUNDS_END> SETTINGS{ {
+			{ 1.f, 1 },
+			{ 0.6f, 1 },
+			{ 0.15f, 1 },
+			{ 0.15f, 2 },
+			{ 0.15f, 2 },
+			{ 1.f, 2 }
+		} };
+
+	struct Voice {
+		irrklang::ISound* sound = nullptr;
+		Sound type = SOUNDS_END;
+		std::uint64_t started = 0;	//Order of the start, the lowest is the oldest
+	};
+
+	irrklang::ISoundEngine* device = nullptr;
+	std::array<irrklang::ISoundSource*, SOUNDS_END> sources{};
+	std::array<Voice, MAX_VOICES> voices{};
+	irrklang::ISound* music = nullptr;
+	std::uint64_t started = 0;
+
+	SpscQueue<Sound, 64> commands;
+	std::atomic<bool> running{ true };
+	std::thread mixer;
+
+	void mix();
+	void start(Sound);
+	Voice& takeVoice(Sound);
+	static void release(Voice&);
+
+public:
+	//The sounds are read from the bundle in place, it has to outlive the audio
+	explicit Audio(Bundle const&);
+	~Audio();
+
+	Audio(Audio const&) = delete;
+	Audio& operator=(Audio const&) = delete;
+
+	bool isAvailable() const { return device != nullptr; }
+
+	//Game thread only. The command is dropped if the mixer is that far behind
+	bool play(Sound sound) { return device && commands.push(sound); }
+};
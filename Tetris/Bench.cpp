@@ -0,0 +1,508 @@
+//Self-play throughput benchmark. Plays the same set of games with 1, 2, 4 ... threads
+//and prints the rates of every run as JSON, nothing here needs a window or a sound device.
+//With --versus the games are matches of several boards which send garbage to each other, it lands on the next tick
+//unless --delay gives a longer one, which lets the threads play longer rounds between two synchronizations
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <span>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "Bot.h"
+#include "Engine.h"
+#include "Match.h"
+#include "MoveGenerator.hpp"
+#include "Rewind.hpp"
+
+//Sizes the engine is built for, the bot plays the standard one only
+enum class Board
+{
+	STANDARD,	//10x20
+	LARGE,		//64x128
+	LARGEST		//256x512
+};
+
+enum class Policy
+{
+	RANDOM,		//Random rotation and column for every tetramino
+	SCRIPTED,	//Rotation and column go round in a fixed order
+	BOT			//Placement search with a single thread per game
+};
+
+struct Options {
+	std::uint32_t games = 1000;
+	std::uint32_t threads = std::max(std::thread::hardware_concurrency(), 1u);
+	std::uint64_t maxPieces = 1000;	//A game which never ends is cut at this number of tetraminos
+	std::uint32_t seed = 1;			//Game k is played with the seed + k
+	Policy policy = Policy::RANDOM;
+	std::size_t botDepth = 2;
+	Board board = Board::STANDARD;
+	std::size_t players = 0;		//Boards of a match, 0 plays single games
+	std::uint64_t delay = Match::DELAY;
+	Engine::Gravity gravity = Engine::Gravity::NAIVE;
+};
+
+//Inputs of one tetramino, rotations and shifts followed by the fall, a shift may cross half of the widest board
+struct Plan {
+	std::array<Engine::MovingType, 4 + 256 / 2> moves{};
+	std::size_t count = 0;
+
+	std::span<Engine::MovingType const> getMoves() const { return { moves.data(), count }; }
+};
+
+struct Totals {
+	std::uint64_t games = 0;
+	std::uint64_t pieces = 0;
+	std::uint64_t lines = 0;
+	std::uint64_t ticks = 0;
+	std::uint64_t evaluated = 0;
+	std::uint64_t garbage = 0;	//Rows sent in the matches
+	std::uint64_t dropped = 0;	//Rows which were not sent because the inbox was full
+};
+
+static const char* boardName(Board board)
+{
+	switch (board)
+	{
+	case Board::LARGE: return "64x128";
+	case Board::LARGEST: return "256x512";
+	default: return "10x20";
+	}
+}
+
+static const char* gravityName(Engine::Gravity gravity)
+{
+	return gravity == Engine::Gravity::CASCADE ? "cascade" : "naive";
+}
+
+static const char* policyName(Policy policy)
+{
+	switch (policy)
+	{
+	case Policy::SCRIPTED: return "scripted";
+	case Policy::BOT: return "bot";
+	default: return "random";
+	}
+}
+
+static Plan makePlan(std::uint32_t rotations, std::int32_t shift)
+{
+	using enum Engine::MovingType;
+
+	Plan plan;
+	for (std::uint32_t i = 0; i < rotations; ++i)
+		plan.moves[plan.count++] = ROTATE;
+	for (std::int32_t i = 0; i < std::abs(shift); ++i)
+		plan.moves[plan.count++] = shift < 0 ? LEFT : RIGHT;
+	plan.moves[plan.count++] = FALL;
+	return plan;
+}
+
+//Inputs of the policy for the current tetramino
+template<class E>
+static Plan choosePlan(Options const& options, E const& engine, std::mt19937& policyRd, Bot* bot)
+{
+	constexpr auto COLUMNS = E::GRID_NUMBER_J;
+	constexpr auto CENTER = (std::int32_t)COLUMNS / 2;
+
+	Plan plan;
+	switch (options.policy)
+	{
+	case Policy::RANDOM:
+		plan = makePlan(policyRd() % 4, (std::int32_t)(policyRd() % COLUMNS) - CENTER);
+		break;
+	case Policy::SCRIPTED:
+	{
+		auto piece = (std::uint32_t)engine.getPieces();
+		plan = makePlan(piece % 4, (std::int32_t)(piece * 3 % COLUMNS) - CENTER);
+		break;
+	}
+	case Policy::BOT:
+		if constexpr (std::is_same_v<E, Engine>)
+		{
+			auto botPlan = bot->think(engine);
+			auto moves = botPlan.getMoves();
+			plan.count = (std::size_t)(std::ranges::copy(moves, plan.moves.begin()).out - plan.moves.begin());
+		}
+		break;
+	}
+	return plan;
+}
+
+//Plays one game to the end, every tetramino gets its whole plan at the tick it appears
+template<class E>
+static void playGame(Options const& options, std::uint32_t seed, Bot* bot, Totals& totals)
+{
+	E engine(seed, E::TICK_RATE, options.gravity);
+	std::mt19937 policyRd(seed);
+
+	while (!engine.isOver() && engine.getPieces() < options.maxPieces)
+	{
+		auto plan = choosePlan(options, engine, policyRd, bot);
+		auto placed = engine.getPieces();
+		engine.step(plan.getMoves());
+		while (engine.getPieces() == placed && !engine.isOver())
+			engine.step();
+	}
+
+	++totals.games;
+	totals.pieces += engine.getPieces();
+	totals.lines += engine.getLines();
+	totals.ticks += engine.getTick();
+}
+
+struct SnapshotRates {
+	std::size_t bytes;
+	double saveNs;
+	double restoreNs;
+};
+
+//Saves a game in the middle into a ring and restores it from there, the way a search branches from a state
+template<class E>
+static SnapshotRates measureSnapshots(Options const& options)
+{
+	constexpr std::uint32_t COUNT = 1 << 16;
+	using Clock = std::chrono::steady_clock;
+
+	E engine(options.seed, E::TICK_RATE, options.gravity);
+	auto scripted = options;
+	scripted.policy = Policy::SCRIPTED;
+	std::mt19937 policyRd(options.seed);
+	while (!engine.isOver() && engine.getPieces() < 50)
+	{
+		auto plan = choosePlan(scripted, engine, policyRd, nullptr);
+		engine.step(plan.getMoves());
+	}
+
+	auto history = std::make_unique<Rewind<E, 64>>();
+	auto start = Clock::now();
+	for (std::uint32_t i = 0; i < COUNT; ++i)
+		history->push(engine);
+	auto saved = Clock::now();
+	std::uint64_t ticks = 0;
+	for (std::uint32_t i = 0; i < COUNT; ++i)
+	{
+		history->rewind(engine, 0);
+		ticks += engine.getTick();
+	}
+	auto restored = Clock::now();
+
+	std::chrono::duration<double, std::nano> save = saved - start, restore = restored - saved;
+	return { sizeof(typename E::Snapshot), save.count() / COUNT, ticks ? restore.count() / COUNT : 0. };
+}
+
+struct MoveRates {
+	double placements;	//Distinct places of a tetramino
+	double searchNs;
+};
+
+//Searches every place of every tetramino of the scripted games, what a bot does before it evaluates them
+static MoveRates measureMoves(Options const& options)
+{
+	constexpr std::uint64_t COUNT = 1 << 12;
+	constexpr std::uint32_t REPEATS = 16;
+	using Clock = std::chrono::steady_clock;
+
+	auto scripted = options;
+	scripted.policy = Policy::SCRIPTED;
+	MoveGenerator generator;
+	std::uint64_t searches = 0, placements = 0;
+	Clock::duration spent{};
+	for (auto seed = options.seed; searches < COUNT; ++seed)
+	{
+		Engine engine(seed, Engine::TICK_RATE, options.gravity);
+		std::mt19937 policyRd(seed);
+		while (!engine.isOver() && engine.getPieces() < options.maxPieces && searches < COUNT)
+		{
+			auto start = Clock::now();
+			for (std::uint32_t k = 0; k < REPEATS; ++k)
+				placements += generator.generate(engine.getField(), engine.getTetramino()).size();
+			spent += Clock::now() - start;
+			searches += REPEATS;
+
+			auto plan = choosePlan(scripted, engine, policyRd, nullptr);
+			auto placed = engine.getPieces();
+			engine.step(plan.getMoves());
+			while (engine.getPieces() == placed && !engine.isOver())
+				engine.step();
+		}
+	}
+
+	std::chrono::duration<double, std::nano> search = spent;
+	return { (double)placements / searches, search.count() / searches };
+}
+
+//Plays all the games with the given number of threads, which take the next game once they are done with theirs
+static Totals run(Options const& options, std::uint32_t threads, double& seconds)
+{
+	std::atomic<std::uint32_t> nextGame{ 0 };
+	std::vector<Totals> totals(threads);
+
+	auto worker = [&](std::uint32_t index) {
+		std::unique_ptr<ThreadPool> pool;
+		std::unique_ptr<Bot> bot;
+		if (options.policy == Policy::BOT)
+		{
+			Bot::Settings settings;
+			settings.depth = options.botDepth;
+			settings.budget = std::chrono::hours(1);
+			pool = std::make_unique<ThreadPool>(1);
+			bot = std::make_unique<Bot>(*pool, settings);
+		}
+
+		auto play = options.board == Board::LARGEST ? &playGame<BasicEngine<256, 512>>
+			: options.board == Board::LARGE ? &playGame<BasicEngine<64, 128>> : &playGame<Engine>;
+		for (auto game = nextGame++; game < options.games; game = nextGame++)
+			play(options, options.seed + game, bot.get(), totals[index]);
+
+		if (bot)
+			totals[index].evaluated = bot->getEvaluated();
+		};
+
+	auto start = std::chrono::steady_clock::now();
+	std::vector<std::thread> workers;
+	for (std::uint32_t i = 0; i < threads; ++i)
+		workers.emplace_back(worker, i);
+	for (auto& thread : workers)
+		thread.join();
+	seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	Totals sum;
+	for (auto const& part : totals)
+	{
+		sum.games += part.games;
+		sum.pieces += part.pieces;
+		sum.lines += part.lines;
+		sum.ticks += part.ticks;
+		sum.evaluated += part.evaluated;
+	}
+	return sum;
+}
+
+//A board of a match with its own policy state, it plays until its match or it is over
+struct Contender {
+	Match* match = nullptr;
+	std::size_t player = 0;
+	std::mt19937 policyRd{};
+	std::unique_ptr<Bot> bot{};
+	std::uint64_t planned = ~0ull;	//Number of the tetramino which got its plan
+	bool playing = true;	//Checked between the rounds, the other boards of the match are not read during them
+
+	bool canStep(Options const& options) const
+	{
+		auto const& engine = match->getEngine(player);
+		return !engine.isOver() && engine.getPieces() < options.maxPieces;
+	}
+
+	void play(Options const& options, std::uint64_t ticks)
+	{
+		for (std::uint64_t i = 0; i < ticks && playing && canStep(options); ++i)
+		{
+			auto const& engine = match->getEngine(player);
+			Plan plan;
+			if (engine.getPieces() != planned)
+			{
+				planned = engine.getPieces();
+				plan = choosePlan(options, engine, policyRd, bot.get());
+			}
+			match->step(player, plan.getMoves());
+		}
+	}
+};
+
+//Plays all the matches on a pool of the given number of threads. Every board plays a round of 'delay' ticks as a task,
+//so the garbage sent in a round is taken in the next one whichever thread sent it and the runs play the same matches
+static Totals runVersus(Options const& options, std::uint32_t threads, double& seconds)
+{
+	//The calling thread runs the tasks too, so one thread steps the boards without a pool.
+	//The bots still search on one, with a single worker of it like in run()
+	std::unique_ptr<ThreadPool> pool;
+	if (threads > 1 || options.policy == Policy::BOT)
+		pool = std::make_unique<ThreadPool>(std::max(threads, 2u) - 1);
+	std::vector<std::unique_ptr<Match>> matches;
+	std::vector<Contender> contenders;
+	for (std::uint32_t game = 0; game < options.games; ++game)
+	{
+		auto seed = options.seed + game * (std::uint32_t)options.players;
+		auto& match = matches.emplace_back(std::make_unique<Match>(options.players, seed, options.delay, Engine::TICK_RATE, options.gravity));
+		for (std::size_t player = 0; player < options.players; ++player)
+		{
+			Contender contender{ match.get(), player, std::mt19937(seed + (std::uint32_t)player) };
+			if (options.policy == Policy::BOT)
+			{
+				Bot::Settings settings;
+				settings.depth = options.botDepth;
+				settings.budget = std::chrono::hours(1);
+				contender.bot = std::make_unique<Bot>(*pool, settings);
+			}
+			contenders.push_back(std::move(contender));
+		}
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	auto anyPlaying = [&options, &contenders]() {
+		bool any = false;
+		for (auto& contender : contenders)
+		{
+			contender.playing = !contender.match->isOver() && contender.canStep(options);
+			any = any || contender.playing;
+		}
+		return any;
+		};
+	auto play = [&options, &contenders](std::size_t k) { contenders[k].play(options, options.delay); };
+	while (anyPlaying())
+		if (threads > 1)
+			pool->parallelFor(contenders.size(), play);
+		else
+			for (std::size_t k = 0; k < contenders.size(); ++k)
+				play(k);
+	seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	Totals sum;
+	sum.games = options.games;
+	for (auto const& contender : contenders)
+	{
+		auto const& engine = contender.match->getEngine(contender.player);
+		sum.pieces += engine.getPieces();
+		sum.lines += engine.getLines();
+		sum.ticks += engine.getTick();
+		sum.garbage += contender.match->getSent(contender.player);
+		sum.dropped += contender.match->getDropped(contender.player);
+		if (contender.bot)
+			sum.evaluated += contender.bot->getEvaluated();
+	}
+	return sum;
+}
+
+static bool parseOptions(int argc, char* argv[], Options& options)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		if (arg == "--help" || i + 1 == argc)
+			return false;
+
+		char const* value = argv[++i];
+		if (arg == "--games")
+			options.games = (std::uint32_t)std::strtoul(value, nullptr, 10);
+		else if (arg == "--threads")
+			options.threads = std::max((std::uint32_t)std::strtoul(value, nullptr, 10), 1u);
+		else if (arg == "--max-pieces")
+			options.maxPieces = std::strtoull(value, nullptr, 10);
+		else if (arg == "--seed")
+			options.seed = (std::uint32_t)std::strtoul(value, nullptr, 10);
+		else if (arg == "--depth")
+			options.botDepth = std::max<std::size_t>(std::strtoul(value, nullptr, 10), 1);
+		else if (arg == "--policy" && !std::strcmp(value, "random"))
+			options.policy = Policy::RANDOM;
+		else if (arg == "--policy" && !std::strcmp(value, "scripted"))
+			options.policy = Policy::SCRIPTED;
+		else if (arg == "--policy" && !std::strcmp(value, "bot"))
+			options.policy = Policy::BOT;
+		else if (arg == "--versus")
+			options.players = std::strtoul(value, nullptr, 10);
+		else if (arg == "--delay")
+			options.delay = std::max<std::uint64_t>(std::strtoull(value, nullptr, 10), 1);
+		else if (arg == "--gravity" && !std::strcmp(value, "naive"))
+			options.gravity = Engine::Gravity::NAIVE;
+		else if (arg == "--gravity" && !std::strcmp(value, "cascade"))
+			options.gravity = Engine::Gravity::CASCADE;
+		else if (arg == "--board" && !std::strcmp(value, "10x20"))
+			options.board = Board::STANDARD;
+		else if (arg == "--board" && !std::strcmp(value, "64x128"))
+			options.board = Board::LARGE;
+		else if (arg == "--board" && !std::strcmp(value, "256x512"))
+			options.board = Board::LARGEST;
+		else
+			return false;
+	}
+	return (options.policy != Policy::BOT && !options.players) || options.board == Board::STANDARD;
+}
+
+int main(int argc, char* argv[])
+{
+	Options options;
+	if (!parseOptions(argc, argv, options))
+	{
+		std::cerr << "Usage: " << argv[0] << " [--games N] [--threads N] [--max-pieces N] [--seed N]"
+			" [--policy random|scripted|bot] [--depth N] [--board 10x20|64x128|256x512] [--versus PLAYERS] [--delay TICKS]"
+			" [--gravity naive|cascade]" << std::endl
+			<< "The bot and the matches play on the 10x20 board only" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	//Thread counts are doubled up to the given one, which is always measured
+	std::vector<std::uint32_t> threadCounts;
+	for (std::uint32_t threads = 1; threads < options.threads; threads *= 2)
+		threadCounts.push_back(threads);
+	threadCounts.push_back(options.threads);
+
+	std::cout << "{\n"
+		<< "  \"board\": \"" << boardName(options.board) << "\",\n"
+		<< "  \"policy\": \"" << policyName(options.policy) << "\",\n"
+		<< "  \"gravity\": \"" << gravityName(options.gravity) << "\",\n"
+		<< "  \"games\": " << options.games << ",\n";
+	if (options.players)
+		std::cout << "  \"players\": " << options.players << ",\n"
+			<< "  \"delay\": " << options.delay << ",\n";
+	std::cout
+		<< "  \"max_pieces\": " << options.maxPieces << ",\n"
+		<< "  \"seed\": " << options.seed << ",\n"
+		<< "  \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n";
+
+	auto snapshots = options.board == Board::LARGEST ? measureSnapshots<BasicEngine<256, 512>>(options)
+		: options.board == Board::LARGE ? measureSnapshots<BasicEngine<64, 128>>(options) : measureSnapshots<Engine>(options);
+	std::cout << "  \"snapshot\": {\"bytes\": " << snapshots.bytes
+		<< ", \"save_ns\": " << snapshots.saveNs
+		<< ", \"restore_ns\": " << snapshots.restoreNs << "},\n";
+
+	//The placement search is made for the bot, which plays the standard board only
+	if (options.board == Board::STANDARD)
+	{
+		auto moves = measureMoves(options);
+		std::cout << "  \"moves\": {\"placements\": " << moves.placements
+			<< ", \"search_ns\": " << moves.searchNs << "},\n";
+	}
+	std::cout << "  \"runs\": [";
+
+	double singleRate = 0.;
+	for (std::size_t k = 0; k < threadCounts.size(); ++k)
+	{
+		auto threads = threadCounts[k];
+		double seconds;
+		auto totals = options.players ? runVersus(options, threads, seconds) : run(options, threads, seconds);
+
+		//Every run plays the same games, so the pieces rate compares the thread counts directly
+		double piecesRate = totals.pieces / seconds;
+		if (k == 0)
+			singleRate = piecesRate / threads;
+
+		std::cout << (k ? ",\n" : "\n")
+			<< "    {\"threads\": " << threads
+			<< ", \"seconds\": " << seconds
+			<< ", \"games\": " << totals.games
+			<< ", \"pieces\": " << totals.pieces
+			<< ", \"lines\": " << totals.lines
+			<< ", \"games_per_sec\": " << totals.games / seconds
+			<< ", \"pieces_per_sec\": " << piecesRate
+			<< ", \"lines_per_sec\": " << totals.lines / seconds
+			<< ", \"ticks_per_sec\": " << totals.ticks / seconds;
+		if (options.policy == Policy::BOT)
+			std::cout << ", \"placements_per_sec\": " << totals.evaluated / seconds;
+		if (options.players)
+			std::cout << ", \"garbage\": " << totals.garbage << ", \"dropped\": " << totals.dropped;
+		std::cout << ", \"scaling_efficiency\": " << piecesRate / (singleRate * threads) << "}";
+	}
+	std::cout << "\n  ]\n}" << std::endl;
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,116 @@
+#pragma once
+#include <glad/glad.h>
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "Engine.h"
+#include "GlState.hpp"
+#include "RenderStats.hpp"
+
+//Cells of many boards kept on the GPU, every board is a layer of an integer texture array.
+//A cell is the color of its tile with SHADOW set for the shadow of the tetramino, the boards which changed
+//since the last update are the only ones uploaded again
+class BoardGrid
+{
+public:
+	static constexpr GLsizei COLUMNS = Engine::GRID_NUMBER_J;
+	static constexpr GLsizei ROWS = Engine::GRID_NUMBER_I;
+	static constexpr GLsizei LAYER_SIZE = COLUMNS * ROWS;
+	static constexpr std::uint8_t SHADOW = 0x10;
+
+private:
+	using Layer = std::array<std::uint8_t, LAYER_SIZE>;
+
+	GLuint unit;
+	GLuint texture;
+	GLsizei capacity = 0;	//Layers of the texture
+	GLsizei count = 0;	//Boards of the last update
+	std::vector<Layer> layers;	//What the GPU has, rows from the top one down
+
+	//The field with the tetramino over it, tiles above the field are not visible
+	static void compose(Engine const& engine, Layer& layer)
+	{
+		auto const& field = engine.getField();
+		for (GLsizei i = 0; i < ROWS; ++i)
+			for (GLsizei j = 0; j < COLUMNS; ++j)
+				layer[i * COLUMNS + j] = field.getColor(i, j);
+
+		auto const& tetramino = engine.getTetramino();
+		for (auto const& pos : tetramino.shadow)
+			if (pos.i >= 0)
+				layer[pos.i * COLUMNS + pos.j] = (std::uint8_t)(tetramino.color | SHADOW);
+		for (auto const& pos : tetramino.tiles_pos)
+			if (pos.i >= 0)
+				layer[pos.i * COLUMNS + pos.j] = tetramino.color;
+	}
+
+	void upload(GLsizei from, GLsizei to)
+	{
+		renderStats.bytesUploaded += (to - from) * LAYER_SIZE;
+		glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, from, COLUMNS, ROWS, to - from, GL_RED_INTEGER, GL_UNSIGNED_BYTE, layers[from].data());
+	}
+
+public:
+	//The texture stays bound to the unit
+	explicit BoardGrid(GLuint unit)
+		: unit(unit)
+	{
+		glGenTextures(1, &texture);
+		glState.bindTexture(unit, GL_TEXTURE_2D_ARRAY, texture);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, 0);
+	}
+
+	~BoardGrid()
+	{
+		glState.deleteTexture(texture);
+	}
+
+	BoardGrid(BoardGrid const&) = delete;
+	BoardGrid& operator=(BoardGrid const&) = delete;
+
+	GLsizei getCount() const { return count; }
+
+	//Neighbouring changed boards go in one upload, the texture grows when there are more boards than layers
+	void update(std::span<Engine const* const> boards)
+	{
+		count = (GLsizei)boards.size();
+		glState.bindTexture(unit, GL_TEXTURE_2D_ARRAY, texture);
+
+		//Rows of a layer are not aligned to four bytes
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+		bool grown = count > capacity;
+		if (grown)
+		{
+			capacity = count;
+			layers.resize(capacity);
+			glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_R8UI, COLUMNS, ROWS, capacity, 0, GL_RED_INTEGER, GL_UNSIGNED_BYTE, nullptr);
+		}
+
+		GLsizei dirtyFrom = -1;
+		Layer layer;
+		for (GLsizei k = 0; k < count; ++k)
+		{
+			compose(*boards[k], layer);
+			bool dirty = grown || layer != layers[k];
+			layers[k] = layer;
+
+			if (dirty && dirtyFrom < 0)
+				dirtyFrom = k;
+			else if (!dirty && dirtyFrom >= 0)
+			{
+				this->upload(dirtyFrom, k);
+				dirtyFrom = -1;
+			}
+		}
+		if (dirtyFrom >= 0)
+			this->upload(dirtyFrom, count);
+
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	}
+};
@@ -0,0 +1,128 @@
+#include "Bot.h"
+
+#include <bit>
+#include <limits>
+#include <vector>
+
+Bot::Bot(ThreadPool& tp)
+	: Bot(tp, Settings{})
+{
+}
+
+Bot::Bot(ThreadPool& tp, Settings st)
+	: pool(tp), settings(st)
+{
+}
+
+//Weighted sum of the aggregate height, holes and bumpiness of the field
+double Bot::evaluate(Engine::Field const& field)
+{
+	using Field = Engine::Field;
+
+	//Heights come from the surface of the field, the holes are the free tiles under it
+	auto const& surface = field.surface;
+	Field::Row covered{};
+	std::int32_t holes = 0;
+	for (std::int32_t i = std::ranges::min(surface); i < (std::int32_t)Engine::GRID_NUMBER_I; ++i)
+		for (std::size_t k = 0; k < Field::WORDS; ++k)
+		{
+			auto row = (Field::Word)(field.row(i)[k] & Field::COLUMNS[k]);
+			holes += std::popcount((Field::Word)(covered[k] & ~row));
+			covered[k] |= row;
+		}
+
+	std::int32_t height = 0;
+	std::int32_t bumpiness = 0;
+	for (std::size_t j = 0; j < surface.size(); ++j)
+	{
+		height += Engine::GRID_NUMBER_I - surface[j];
+		if (j + 1 < surface.size())
+			bumpiness += std::abs(surface[j] - surface[j + 1]);
+	}
+
+	return HEIGHT_WEIGHT * height + HOLES_WEIGHT * holes + BUMPINESS_WEIGHT * bumpiness;
+}
+
+double Bot::search(Engine::Field const& field, std::span<Engine::TetraminoPrototype const> pieces, std::uint32_t delay,
+	std::size_t depth, Clock::time_point deadline, bool& timedOut, std::uint64_t& count) const
+{
+	++count;
+	if (!depth || pieces.empty())
+		return evaluate(field);
+
+	if (timedOut || Clock::now() > deadline)
+	{
+		timedOut = true;
+		return 0.;
+	}
+
+	//The tetramino appears the same way the engine spawns it
+	Engine::Tetramino tetramino{};
+	tetramino.update(field, pieces.front(), delay);
+	if (std::ranges::any_of(tetramino.tiles_pos, [](Engine::Pos const& pos) { return pos.i < 0; }))
+		return GAME_OVER_SCORE;
+
+	double best = GAME_OVER_SCORE;
+	forEachPlacement(field, tetramino, [&](Placement const&, Engine::Field const& next, std::uint32_t lines) {
+		best = std::max(best, LINES_WEIGHT * lines + search(next, pieces.subspan(1), delay, depth - 1, deadline, timedOut, count));
+		}
+	);
+	return best;
+}
+
+Bot::Plan Bot::think(Engine const& engine)
+{
+	auto deadline = Clock::now() + settings.budget;
+	auto const& field = engine.getField();
+	auto const& tetramino = engine.getTetramino();
+	auto const& next = engine.getNextTetraminos();
+
+	struct Root {
+		Placement placement;
+		Engine::Field field;
+		std::uint32_t lines;
+		double score;
+	};
+	std::vector<Root> roots;
+	forEachPlacement(field, tetramino, [&](Placement const& placement, Engine::Field const& after, std::uint32_t lines) {
+		roots.push_back({ placement, after, lines, 0. });
+		}
+	);
+
+	Plan plan;
+	if (roots.empty())
+		return plan;
+
+	//Iterative deepening, a level which runs out of time is thrown away and the previous one is kept
+	Placement best = roots.front().placement;
+	depthReached = 0;
+	for (std::size_t depth = 1; depth <= settings.depth; ++depth)
+	{
+		std::atomic<bool> anyTimedOut{ false };
+		pool.parallelFor(roots.size(), [&](std::size_t k) {
+			auto& root = roots[k];
+			bool timedOut = false;
+			std::uint64_t count = 0;
+			root.score = LINES_WEIGHT * root.lines + search(root.field, next, tetramino.slowDelay, depth - 1,
+				depth == 1 ? Clock::time_point::max() : deadline, timedOut, count);
+
+			evaluated.fetch_add(count, std::memory_order_relaxed);
+			if (timedOut)
+				anyTimedOut.store(true, std::memory_order_relaxed);
+			}
+		);
+		if (anyTimedOut)
+			break;
+
+		best = std::ranges::max(roots, {}, &Root::score).placement;
+		depthReached = (std::uint32_t)depth;
+	}
+
+	using enum Engine::MovingType;
+	for (std::uint32_t i = 0; i < best.rotations; ++i)
+		plan.moves[plan.count++] = ROTATE;
+	for (std::int32_t i = 0; i < std::abs(best.shift); ++i)
+		plan.moves[plan.count++] = best.shift < 0 ? LEFT : RIGHT;
+	plan.moves[plan.count++] = FALL;
+	return plan;
+}
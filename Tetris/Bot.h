@@ -0,0 +1,111 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <span>
+
+#include "Engine.h"
+#include "ThreadPool.h"
+
+//Plays by searching every rotation and column of the current tetramino and of the next ones.
+//Placements are simulated with the engine's own moving rules, so the chosen inputs do the same when the engine applies them.
+//The first level is spread over the thread pool, deeper levels are searched while the time budget lasts
+class Bot
+{
+public:
+	struct Settings {
+		std::size_t depth = 3;	//Tetraminos to look at, the current one included
+		std::chrono::microseconds budget{ 5000 };	//Time for one move
+	};
+
+	struct Placement {
+		std::uint32_t rotations;
+		std::int32_t shift;	//Columns, negative is to the left
+	};
+
+	//Inputs of one move, rotations and shifts followed by the fall
+	struct Plan {
+		std::array<Engine::MovingType, 16> moves{};
+		std::size_t count = 0;
+
+		std::span<Engine::MovingType const> getMoves() const { return { moves.data(), count }; }
+	};
+
+	//Weights of the field evaluation
+	static constexpr double HEIGHT_WEIGHT = -0.510066;
+	static constexpr double LINES_WEIGHT = 0.760666;
+	static constexpr double HOLES_WEIGHT = -0.35663;
+	static constexpr double BUMPINESS_WEIGHT = -0.184483;
+	static constexpr double GAME_OVER_SCORE = -1e9;
+
+private:
+	using Clock = std::chrono::steady_clock;
+
+	ThreadPool& pool;
+	Settings settings;
+	std::atomic<std::uint64_t> evaluated{ 0 };
+	std::uint32_t depthReached = 0;
+
+	static double evaluate(Engine::Field const&);
+	double search(Engine::Field const&, std::span<Engine::TetraminoPrototype const>, std::uint32_t delay,
+		std::size_t depth, Clock::time_point deadline, bool& timedOut, std::uint64_t& count) const;
+
+public:
+	explicit Bot(ThreadPool&);
+	Bot(ThreadPool&, Settings);
+
+	//Calls f(placement, field after it, cleared lines) for every distinct placement of the tetramino
+	template<class F>
+	static void forEachPlacement(Engine::Field const&, Engine::Tetramino const&, F&& f);
+
+	Plan think(Engine const&);
+
+	std::uint64_t getEvaluated() const { return evaluated.load(std::memory_order_relaxed); }	//Placements in total
+	std::uint32_t getDepthReached() const { return depthReached; }	//Depth of the last move
+};
+
+template<class F>
+void Bot::forEachPlacement(Engine::Field const& field, Engine::Tetramino const& tetramino, F&& f)
+{
+	//Different inputs may end at the same place, e.g. for the symmetrical tetraminos
+	std::array<std::array<Engine::Pos, 4>, 4 * 2 * Engine::GRID_NUMBER_J> seen;
+	std::size_t seenCount = 0;
+
+	auto rotated = tetramino;
+	for (std::uint32_t rotations = 0; rotations < 4; ++rotations)
+	{
+		if (rotations && !rotated.rotate(field))
+			break;
+
+		for (std::int32_t direction : { -1, 1 })
+		{
+			auto shifted = rotated;
+			for (std::int32_t shift = 0; ; shift += direction)
+			{
+				if (shift && !(direction < 0 ? shifted.moveLeft(field) : shifted.moveRight(field)))
+					break;
+
+				//Zero shift is visited by the first direction only
+				if (!shift && direction > 0)
+					continue;
+
+				auto key = shifted.shadow;
+				std::ranges::sort(key, {}, [](Engine::Pos const& pos) { return pos.i * 64 + pos.j; });
+				if (std::ranges::find(seen.begin(), seen.begin() + seenCount, key) != seen.begin() + seenCount)
+					continue;
+				seen[seenCount++] = key;
+
+				auto placed = shifted;
+				placed.fall();
+				auto next = field;
+				if (!placed.addToField(next))
+					continue;
+				auto lines = next.clearLines();
+
+				f(Placement{ rotations, shift }, next, lines);
+			}
+		}
+	}
+}
@@ -0,0 +1,223 @@
+#include "Bundle.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static std::size_t alignUp(std::size_t value)
+{
+	return (value + Bundle::ALIGNMENT - 1) / Bundle::ALIGNMENT * Bundle::ALIGNMENT;
+}
+
+std::size_t Bundle::levelSize(Entry const& entry, std::uint32_t level)
+{
+	return (std::size_t)std::max(entry.width >> level, 1u) * std::max(entry.height >> level, 1u) * 4;
+}
+
+Bundle::Entry& Bundle::Writer::add(std::string_view name, Type type, std::vector<std::uint8_t> data)
+{
+	Entry entry{};
+	std::copy_n(name.begin(), std::min(name.size(), NAME_SIZE - 1), entry.name.begin());
+	entry.type = type;
+	entry.size = data.size();
+
+	blobs.push_back(std::move(data));
+	return entries.emplace_back(entry);
+}
+
+void Bundle::Writer::addImage(std::string_view name, std::uint8_t const* rgba, std::uint32_t width, std::uint32_t height, std::uint32_t layers)
+{
+	auto layerWidth = width / layers;
+	auto levels = (std::uint32_t)std::bit_width(std::max(layerWidth, height));
+
+	//Level 0 is the image cut into the layers
+	std::vector<std::uint8_t> pixels;
+	for (std::uint32_t layer = 0; layer < layers; ++layer)
+		for (std::uint32_t y = 0; y < height; ++y)
+		{
+			auto const* row = rgba + ((std::size_t)y * width + layer * layerWidth) * 4;
+			pixels.insert(pixels.end(), row, row + layerWidth * 4);
+		}
+
+	//Every next level averages 2x2 texels of the previous one, the last row or column is repeated at odd sizes
+	std::size_t previous = 0;
+	for (std::uint32_t level = 1; level < levels; ++level)
+	{
+		auto srcW = std::max(layerWidth >> (level - 1), 1u);
+		auto srcH = std::max(height >> (level - 1), 1u);
+		auto dstW = std::max(srcW / 2, 1u);
+		auto dstH = std::max(srcH / 2, 1u);
+		auto current = pixels.size();
+		pixels.resize(current + (std::size_t)dstW * dstH * 4 * layers);
+
+		for (std::uint32_t layer = 0; layer < layers; ++layer)
+		{
+			auto const* src = pixels.data() + previous + (std::size_t)layer * srcW * srcH * 4;
+			auto* dst = pixels.data() + current + (std::size_t)layer * dstW * dstH * 4;
+			for (std::uint32_t y = 0; y < dstH; ++y)
+				for (std::uint32_t x = 0; x < dstW; ++x)
+				{
+					auto x0 = std::min(2 * x, srcW - 1), x1 = std::min(2 * x + 1, srcW - 1);
+					auto y0 = std::min(2 * y, srcH - 1), y1 = std::min(2 * y + 1, srcH - 1);
+					for (std::uint32_t c = 0; c < 4; ++c)
+					{
+						auto sum = src[(y0 * srcW + x0) * 4 + c] + src[(y0 * srcW + x1) * 4 + c]
+							+ src[(y1 * srcW + x0) * 4 + c] + src[(y1 * srcW + x1) * 4 + c];
+						dst[(y * dstW + x) * 4 + c] = (std::uint8_t)((sum + 2) / 4);
+					}
+				}
+		}
+		previous = current;
+	}
+
+	auto& entry = this->add(name, Type::IMAGE, std::move(pixels));
+	entry.width = layerWidth;
+	entry.height = height;
+	entry.layers = layers;
+	entry.levels = levels;
+}
+
+void Bundle::Writer::addSound(std::string_view name, std::span<std::uint8_t const> file)
+{
+	this->add(name, Type::SOUND, { file.begin(), file.end() });
+}
+
+std::vector<std::uint8_t> Bundle::Writer::finish() const
+{
+	Header header{ MAGIC, VERSION, (std::uint32_t)entries.size(), 0 };
+	auto index = entries;
+
+	auto offset = alignUp(sizeof(Header) + index.size() * sizeof(Entry));
+	for (auto& entry : index)
+	{
+		entry.offset = offset;
+		offset = alignUp(offset + entry.size);
+	}
+
+	std::vector<std::uint8_t> bytes(offset);
+	std::memcpy(bytes.data(), &header, sizeof(header));
+	std::memcpy(bytes.data() + sizeof(header), index.data(), index.size() * sizeof(Entry));
+	for (std::size_t k = 0; k < index.size(); ++k)
+		std::ranges::copy(blobs[k], bytes.begin() + index[k].offset);
+	return bytes;
+}
+
+Bundle::~Bundle()
+{
+	if (!mapped)
+		return;
+
+#ifdef _WIN32
+	UnmapViewOfFile(data);
+#else
+	munmap((void*)data, size);
+#endif
+}
+
+//The header, the index and every entry have to be inside the bundle
+bool Bundle::validate() const
+{
+	if (size < sizeof(Header))
+		return false;
+
+	auto const* header = (Header const*)data;
+	if (header->magic != MAGIC || header->version != VERSION || (size - sizeof(Header)) / sizeof(Entry) < header->count)
+		return false;
+
+	return std::ranges::all_of(this->getEntries(), [this](Entry const& entry) {
+		if (entry.offset > size || entry.size > size - entry.offset || entry.name.back() != '\0')
+			return false;
+		if (entry.type != Type::IMAGE)
+			return true;
+
+		//Every level the uploads read has to be there
+		if (!entry.levels || entry.levels > 32 || !entry.layers)
+			return false;
+		std::uint64_t imageSize = 0;
+		for (std::uint32_t level = 0; level < entry.levels; ++level)
+			imageSize += (std::uint64_t)levelSize(entry, level) * entry.layers;
+		return imageSize <= entry.size;
+		}
+	);
+}
+
+std::unique_ptr<Bundle> Bundle::map(const char* path)
+{
+	std::unique_ptr<Bundle> bundle(new Bundle);
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return nullptr;
+
+	LARGE_INTEGER fileSize;
+	HANDLE mapping = GetFileSizeEx(file, &fileSize) && fileSize.QuadPart
+		? CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+	CloseHandle(file);
+	if (!mapping)
+		return nullptr;
+
+	//The view keeps the file mapped after the handles are closed
+	bundle->data = (std::uint8_t const*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(mapping);
+	if (!bundle->data)
+		return nullptr;
+	bundle->size = (std::size_t)fileSize.QuadPart;
+#else
+	int file = open(path, O_RDONLY);
+	if (file < 0)
+		return nullptr;
+
+	struct stat info;
+	void* view = fstat(file, &info) == 0 && info.st_size
+		? mmap(nullptr, (std::size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0) : MAP_FAILED;
+	close(file);
+	if (view == MAP_FAILED)
+		return nullptr;
+
+	bundle->data = (std::uint8_t const*)view;
+	bundle->size = (std::size_t)info.st_size;
+#endif
+
+	bundle->mapped = true;
+	return bundle->validate() ? std::move(bundle) : nullptr;
+}
+
+std::unique_ptr<Bundle> Bundle::fromMemory(std::vector<std::uint8_t> bytes)
+{
+	std::unique_ptr<Bundle> bundle(new Bundle);
+	bundle->owned = std::move(bytes);
+	bundle->data = bundle->owned.data();
+	bundle->size = bundle->owned.size();
+	return bundle->validate() ? std::move(bundle) : nullptr;
+}
+
+std::span<Bundle::Entry const> Bundle::getEntries() const
+{
+	return { (Entry const*)(data + sizeof(Header)), ((Header const*)data)->count };
+}
+
+Bundle::Entry const* Bundle::find(std::string_view name) const
+{
+	auto entries = this->getEntries();
+	auto it = std::ranges::find_if(entries, [name](Entry const& entry) { return name == entry.name.data(); });
+	return it != entries.end() ? &*it : nullptr;
+}
+
+std::uint8_t const* Bundle::getLevel(Entry const& entry, std::uint32_t level) const
+{
+	auto const* pixels = this->getData(entry);
+	for (std::uint32_t l = 0; l < level; ++l)
+		pixels += levelSize(entry, l) * entry.layers;
+	return pixels;
+}
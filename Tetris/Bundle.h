@@ -0,0 +1,93 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
+
+//Assets decoded ahead of time into one file, which is memory-mapped and used in place.
+//Binary layout, numbers are little-endian as the structures are used straight from the memory:
+//	header	Header
+//	index	Entry for every asset
+//	data	every asset starts at a multiple of ALIGNMENT
+//Images are RGBA8 rows from the bottom one up. Every mipmap level holds all the layers one after another
+class Bundle
+{
+public:
+	static_assert(std::endian::native == std::endian::little, "Bundles are mapped as they are stored");
+
+	static constexpr std::array<char, 4> MAGIC{ 'T', 'P', 'A', 'K' };
+	static constexpr std::uint32_t VERSION = 1;
+	static constexpr std::size_t ALIGNMENT = 64;
+	static constexpr std::size_t NAME_SIZE = 32;
+
+	enum class Type : std::uint32_t
+	{
+		IMAGE,
+		SOUND	//Whole sound file, PCM unless it is streamed
+	};
+
+	struct Header {
+		std::array<char, 4> magic;
+		std::uint32_t version;
+		std::uint32_t count;
+		std::uint32_t padding;
+	};
+
+	struct Entry {
+		std::array<char, NAME_SIZE> name;	//Zero-terminated
+		Type type;
+		std::uint32_t width;	//Of a layer
+		std::uint32_t height;
+		std::uint32_t layers;	//Texture array layers
+		std::uint32_t levels;	//Mipmap levels
+		std::uint32_t padding;
+		std::uint64_t offset;	//From the start of the bundle
+		std::uint64_t size;
+	};
+
+	//Builds a bundle in memory, 'Tetris/Packer.cpp' fills it with the decoded resources
+	class Writer
+	{
+		std::vector<Entry> entries;
+		std::vector<std::vector<std::uint8_t>> blobs;
+
+		Entry& add(std::string_view name, Type, std::vector<std::uint8_t> data);
+
+	public:
+		//The image has its layers side by side, all the mipmap levels are made here
+		void addImage(std::string_view name, std::uint8_t const* rgba, std::uint32_t width, std::uint32_t height, std::uint32_t layers);
+		void addSound(std::string_view name, std::span<std::uint8_t const> file);
+
+		std::vector<std::uint8_t> finish() const;
+	};
+
+	static std::size_t levelSize(Entry const&, std::uint32_t level);	//Bytes of one layer
+
+private:
+	std::uint8_t const* data = nullptr;
+	std::size_t size = 0;
+	std::vector<std::uint8_t> owned;	//Bundle made in memory
+	bool mapped = false;				//'data' is a view of a mapped file
+
+	Bundle() = default;
+	bool validate() const;
+
+public:
+	~Bundle();
+
+	Bundle(Bundle const&) = delete;
+	Bundle& operator=(Bundle const&) = delete;
+
+	//Null if the file is missing or is not a bundle of this version
+	static std::unique_ptr<Bundle> map(const char* path);
+	static std::unique_ptr<Bundle> fromMemory(std::vector<std::uint8_t>);
+
+	std::span<Entry const> getEntries() const;
+	Entry const* find(std::string_view name) const;
+	std::uint8_t const* getData(Entry const& entry) const { return data + entry.offset; }
+	std::uint8_t const* getLevel(Entry const&, std::uint32_t level) const;	//All the layers of the level
+};
@@ -0,0 +1,209 @@
+#include "Engine.h"
+
+#include <algorithm>
+#include <cmath>
+
+template<std::uint32_t Width, std::uint32_t Height>
+BasicEngine<Width, Height>::BasicEngine(std::uint32_t sd, std::uint32_t rate, Gravity gr)
+	: seed(sd), tickRate(rate), gravity(gr), rd(sd), garbageRd(~(std::uint64_t)sd)
+{
+	auto toTicks = [rate](float seconds) { return std::max((std::uint32_t)std::lround(seconds * rate), 1u); };
+	tetramino.slowDelay = toTicks(SLOW_DELAY);
+	tetramino.fastDelay = toTicks(FAST_DELAY);
+	tetramino.fallTimer = 0;
+
+	//Fill the queue first so the current tetramino is taken from the same generator sequence
+	std::ranges::generate(next_tetraminos, [this]() { return generatePrototype(); });
+	tetramino.update(field, generatePrototype(), tetramino.slowDelay);
+}
+
+template<std::uint32_t Width, std::uint32_t Height>
+EngineBase::TetraminoPrototype BasicEngine<Width, Height>::generatePrototype()
+{
+	TetraminoPrototype prot;
+	prot.color = (TileColor)((rd() % (TileColor::COLORS_END - 1)) + 1);
+	prot.shape = (Shape)(rd() % SHAPES_NUMBER);
+	return prot;
+}
+
+template<std::uint32_t Width, std::uint32_t Height>
+EngineBase::Events BasicEngine<Width, Height>::step(std::span<MovingType const> inputs)
+{
+	//Nothing changes after the game is over
+	if (!isGame)
+		return NO_EVENT;
+
+	++tick;
+	Events events = NO_EVENT;
+	for (auto move : inputs)
+		events |= tetramino.process_input(field, move);
+
+	events |= this->updateTetramino();
+	if (this->checkForGameOver())
+		events |= GAME_OVER;
+
+	return events;
+}
+
+//The game is over when taken tiles are pushed out of the field or the tetramino cannot get out of the garbage
+template<std::uint32_t Width, std::uint32_t Height>
+EngineBase::Events BasicEngine<Width, Height>::addGarbage(std::uint32_t rows)
+{
+	if (!isGame || !rows)
+		return NO_EVENT;
+
+	isGame = field.raise(rows, (std::int32_t)(garbageRd() % Width), GARBAGE_COLOR);
+
+	//The tetramino is lifted as little as it needs, the field under it went up by 'rows'
+	for (std::uint32_t k = 0; k < rows && !tetramino.canMoveTowards(field, { 0, 0 }); ++k)
+		tetramino.advancePos({ -1, 0 });
+	isGame = isGame && tetramino.canMoveTowards(field, { 0, 0 });
+	tetramino.updateShadow(field);
+
+	return isGame ? GARBAGE : GARBAGE | GAME_OVER;
+}
+
+template<std::uint32_t Width, std::uint32_t Height>
+EngineBase::Events BasicEngine<Width, Height>::updateTetramino()
+{
+	//Move tetramino down
+	tetramino.moveDown(field);
+
+	//Do nothing if tetramino is not placed
+	if (!tetramino.isPlaced)
+		return NO_EVENT;
+
+	//Leave it at its place, a tetramino which overlaps taken tiles is lost and so is the game
+	if (!tetramino.addToField(field))
+	{
+		isGame = false;
+		return NO_EVENT;
+	}
+	++pieces;
+
+	//Check lines to clear
+	Events events = PLACED;
+	if (auto cleared = this->clearLines())
+	{
+		lines += cleared;
+		events |= LINE_CLEAR;
+	}
+
+	//And update, the game is over when the next one has no place even one row higher
+	this->updateNextTetraminos();
+	if (!tetramino.canMoveTowards(field, { 0, 0 }))
+		isGame = false;
+	return events;
+}
+
+//Updates the current tetramino and the next tetraminos
+template<std::uint32_t Width, std::uint32_t Height>
+void BasicEngine<Width, Height>::updateNextTetraminos()
+{
+	tetramino.update(field, next_tetraminos.front(), tetramino.delay);
+	std::move(next_tetraminos.begin() + 1, next_tetraminos.end(), next_tetraminos.begin());
+	next_tetraminos.back() = generatePrototype();
+}
+
+//Returns the number of cleared lines. The zone is here and not in the field, which the bot clears for every placement it tries
+template<std::uint32_t Width, std::uint32_t Height>
+std::uint32_t BasicEngine<Width, Height>::clearLines()
+{
+	auto cleared = gravity == Gravity::CASCADE ? field.cascade() : field.clearLines();
+	if (cleared)
+		tetramino.updateShadow(field);
+	return cleared;
+}
+
+//Checks whether a tetramino was placed out of the upper bounds of the field or the last one had no place
+template<std::uint32_t Width, std::uint32_t Height>
+bool BasicEngine<Width, Height>::checkForGameOver()
+{
+	isGame = isGame && std::ranges::all_of(tetramino.tiles_pos, [](Pos const& tile_pos) {
+		return tile_pos.i >= 0;
+		}
+	);
+	return !isGame;
+}
+
+template<std::uint32_t Width, std::uint32_t Height>
+void BasicEngine<Width, Height>::save(Snapshot& snapshot) const
+{
+	static_assert(std::is_trivially_copyable_v<Snapshot>);
+
+	std::copy_n(field.rows.begin() + Field::HIDDEN_ROWS, Height, snapshot.rows.begin());
+	for (std::uint32_t i = 0; i < Height; ++i)
+	{
+		auto const& colors = field.colors[i];
+		auto& packed = snapshot.colors[i];
+		for (std::uint32_t j = 0; j + 1 < Width; j += 2)
+			packed[j / 2] = (std::uint8_t)(colors[j] | colors[j + 1] << 4);
+		if constexpr (Width % 2)
+			packed.back() = colors.back();
+	}
+
+	snapshot.tick = tick;
+	snapshot.pieces = pieces;
+	snapshot.lines = lines;
+	snapshot.rd = rd;
+	snapshot.garbageRd = garbageRd;
+	snapshot.seed = seed;
+	snapshot.tickRate = tickRate;
+	snapshot.delay = tetramino.delay;
+	snapshot.slowDelay = tetramino.slowDelay;
+	snapshot.fastDelay = tetramino.fastDelay;
+	snapshot.fallTimer = tetramino.fallTimer;
+	snapshot.pivotI = (std::int16_t)tetramino.pivot.i;
+	snapshot.pivotJ = (std::int16_t)tetramino.pivot.j;
+	snapshot.color = tetramino.color;
+	snapshot.shape = tetramino.shape;
+	snapshot.rotation = (std::uint8_t)tetramino.rotation;
+	snapshot.isPlaced = tetramino.isPlaced;
+	snapshot.next = next_tetraminos;
+	snapshot.gravity = gravity;
+	snapshot.isGame = isGame;
+}
+
+//The rows above and below the field never change, the surface and the shadow are found from the restored rows
+template<std::uint32_t Width, std::uint32_t Height>
+void BasicEngine<Width, Height>::restore(Snapshot const& snapshot)
+{
+	std::ranges::copy(snapshot.rows, field.rows.begin() + Field::HIDDEN_ROWS);
+	for (std::uint32_t i = 0; i < Height; ++i)
+	{
+		auto& colors = field.colors[i];
+		auto const& packed = snapshot.colors[i];
+		for (std::uint32_t j = 0; j + 1 < Width; j += 2)
+		{
+			colors[j] = (TileColor)(packed[j / 2] & 0x0F);
+			colors[j + 1] = (TileColor)(packed[j / 2] >> 4);
+		}
+		if constexpr (Width % 2)
+			colors.back() = (TileColor)packed.back();
+	}
+	field.updateSurface();
+
+	tick = snapshot.tick;
+	pieces = snapshot.pieces;
+	lines = snapshot.lines;
+	rd = snapshot.rd;
+	garbageRd = snapshot.garbageRd;
+	seed = snapshot.seed;
+	tickRate = snapshot.tickRate;
+	tetramino.delay = snapshot.delay;
+	tetramino.slowDelay = snapshot.slowDelay;
+	tetramino.fastDelay = snapshot.fastDelay;
+	tetramino.fallTimer = snapshot.fallTimer;
+	tetramino.color = snapshot.color;
+	tetramino.shape = snapshot.shape;
+	tetramino.isPlaced = snapshot.isPlaced;
+	tetramino.place({ snapshot.pivotI, snapshot.pivotJ }, snapshot.rotation);
+	tetramino.updateShadow(field);
+	next_tetraminos = snapshot.next;
+	gravity = snapshot.gravity;
+	isGame = snapshot.isGame;
+}
+
+template class BasicEngine<10, 20>;
+template class BasicEngine<64, 128>;
+template class BasicEngine<256, 512>;
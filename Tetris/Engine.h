@@ -0,0 +1,436 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <type_traits>
+
+//Game rules without any window, graphics or sound dependency.
+//The engine is advanced only by explicit step() calls, so any number of them can run headless
+
+//Colors of the tiles, the value is the index of the tile in the tiles texture
+enum TileColor : std::uint8_t
+{
+	NONE,
+	PURPLE,
+	RED,
+	GREEN,
+	YELLOW,
+	SKY,
+	ORANGE,
+	BLUE,
+	COLORS_END
+};
+
+//SplitMix64 generator of the tetraminos and the garbage holes. Its state is a single number, so the whole
+//game can be saved in a few hundred bytes and copied as they are
+class Random
+{
+	std::uint64_t state;
+
+public:
+	using result_type = std::uint32_t;
+
+	Random() : state(0) {}
+	explicit Random(std::uint64_t seed) : state(seed) {}
+
+	static constexpr result_type min() { return 0; }
+	static constexpr result_type max() { return UINT32_MAX; }
+
+	result_type operator()()
+	{
+		auto z = (state += 0x9E3779B97F4A7C15ull);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return (result_type)((z ^ (z >> 31)) >> 32);
+	}
+};
+
+//The part of the rules which does not depend on the size of the board
+class EngineBase
+{
+public:
+	static constexpr std::size_t NEXT_NUMBER = 3;
+
+	//Default simulation rate, gravity delays are given in seconds and converted to ticks of the chosen rate
+	static constexpr std::uint32_t TICK_RATE = 60;
+	static constexpr float SLOW_DELAY = 0.7f;
+	static constexpr float FAST_DELAY = 0.05f;
+
+	//What falls after a line clear: the rows above it, or every connected clump of tiles on its own,
+	//which can fill more rows and clear them in a chain
+	enum class Gravity : std::uint8_t
+	{
+		NAIVE,
+		CASCADE
+	};
+
+	//Tiles of the rows sent by the opponents, the tiles texture has no color of its own for them
+	static constexpr TileColor GARBAGE_COLOR = BLUE;
+
+	enum class MovingType
+	{
+		LEFT,
+		RIGHT,
+		FAST,
+		SLOW,
+		ROTATE,
+		FALL
+	};
+
+	//Input with the time it was captured at, in seconds of the capturing clock
+	struct InputEvent {
+		MovingType move;
+		double time;
+	};
+
+	//What happened during a step, the frontend reacts on it with sounds
+	enum Event : std::uint32_t
+	{
+		NO_EVENT	= 0,
+		MOVED		= 1 << 0,
+		ROTATED		= 1 << 1,
+		FELL		= 1 << 2,
+		PLACED		= 1 << 3,
+		LINE_CLEAR	= 1 << 4,
+		GAME_OVER	= 1 << 5,
+		GARBAGE		= 1 << 6
+	};
+	using Events = std::uint32_t;
+
+	struct Pos {
+		std::int32_t i;
+		std::int32_t j;
+
+		bool operator==(Pos const& other) const = default;
+	};//Represent position as 'i', 'j' indices
+
+	enum class Shape : std::uint8_t
+	{
+		I,
+		J,
+		L,
+		O,
+		S,
+		T,
+		Z,
+		SHAPES_END
+	};
+	static constexpr std::size_t SHAPES_NUMBER = (std::size_t)Shape::SHAPES_END;
+
+	//Displays information about the next tetraminos
+	struct TetraminoPrototype {
+		TileColor color;
+		Shape shape;
+	};
+
+	//Rotation states of every shape and the SRS kicks between them, all of it is generated at compile time.
+	//A state is the spawn cells turned around the pivot cell, the kicks are the differences of the SRS offsets
+	struct Rotations
+	{
+		static constexpr std::size_t STATES_NUMBER = 4;
+		static constexpr std::size_t KICKS_NUMBER = 5;
+
+		struct State {
+			std::array<Pos, 4> cells;	//Offsets from the pivot
+			std::int32_t top;			//Offset of the top row of the mask
+			std::int32_t left;			//Offset of the leftmost column of the mask
+			std::int32_t width;
+			std::array<std::uint8_t, 4> mask;	//Rows from the top one down, the leftmost column is bit 0
+			std::array<std::int32_t, 4> bottoms;	//Offset of the lowest cell of every column from the leftmost one
+		};
+		using Kicks = std::array<Pos, KICKS_NUMBER>;
+
+		//Cells of the spawn state, 'i' goes down and 'j' goes right
+		static constexpr std::array<std::array<Pos, 4>, SHAPES_NUMBER> SPAWN_CELLS{ {
+				{ { { 0, -1 }, { 0, 0 }, { 0, 1 }, { 0, 2 } } },		//I
+				{ { { -1, -1 }, { 0, -1 }, { 0, 0 }, { 0, 1 } } },		//J
+				{ { { -1, 1 }, { 0, -1 }, { 0, 0 }, { 0, 1 } } },		//L
+				{ { { -1, 0 }, { -1, 1 }, { 0, 0 }, { 0, 1 } } },		//O
+				{ { { -1, 0 }, { -1, 1 }, { 0, -1 }, { 0, 0 } } },		//S
+				{ { { -1, 0 }, { 0, -1 }, { 0, 0 }, { 0, 1 } } },		//T
+				{ { { -1, -1 }, { -1, 0 }, { 0, 0 }, { 0, 1 } } }		//Z
+			} };
+
+		//SRS offsets of the states as (x, y) with 'y' going up, the I and the O have their own ones
+		using Offsets = std::array<std::array<Pos, KICKS_NUMBER>, STATES_NUMBER>;
+		static constexpr Offsets COMMON_OFFSETS{ {
+				{ { { 0, 0 }, { 0, 0 }, { 0, 0 }, { 0, 0 }, { 0, 0 } } },
+				{ { { 0, 0 }, { 1, 0 }, { 1, -1 }, { 0, 2 }, { 1, 2 } } },
+				{ { { 0, 0 }, { 0, 0 }, { 0, 0 }, { 0, 0 }, { 0, 0 } } },
+				{ { { 0, 0 }, { -1, 0 }, { -1, -1 }, { 0, 2 }, { -1, 2 } } }
+			} };
+		static constexpr Offsets I_OFFSETS{ {
+				{ { { 0, 0 }, { -1, 0 }, { 2, 0 }, { -1, 0 }, { 2, 0 } } },
+				{ { { -1, 0 }, { 0, 0 }, { 0, 0 }, { 0, 1 }, { 0, -2 } } },
+				{ { { -1, 1 }, { 1, 1 }, { -2, 1 }, { 1, 0 }, { -2, 0 } } },
+				{ { { 0, 1 }, { 0, 1 }, { 0, 1 }, { 0, -1 }, { 0, 2 } } }
+			} };
+		static constexpr Offsets O_OFFSETS{ {
+				{ { { 0, 0 }, { 0, 0 }, { 0, 0 }, { 0, 0 }, { 0, 0 } } },
+				{ { { 0, -1 }, { 0, -1 }, { 0, -1 }, { 0, -1 }, { 0, -1 } } },
+				{ { { -1, -1 }, { -1, -1 }, { -1, -1 }, { -1, -1 }, { -1, -1 } } },
+				{ { { -1, 0 }, { -1, 0 }, { -1, 0 }, { -1, 0 }, { -1, 0 } } }
+			} };
+
+		//STATES[shape][rotation], every rotation is a quarter turn clockwise
+		static constexpr auto STATES = []() {
+			std::array<std::array<State, STATES_NUMBER>, SHAPES_NUMBER> states{};
+			for (std::size_t shape = 0; shape < SHAPES_NUMBER; ++shape)
+			{
+				auto cells = SPAWN_CELLS[shape];
+				for (auto& state : states[shape])
+				{
+					state.cells = cells;
+					state.top = state.left = 4;
+					std::int32_t right = -4;
+					for (auto const& cell : cells)
+					{
+						state.top = std::min(state.top, cell.i);
+						state.left = std::min(state.left, cell.j);
+						right = std::max(right, cell.j);
+					}
+					state.width = right - state.left + 1;
+
+					state.mask = {};
+					state.bottoms.fill(-4);
+					for (auto const& cell : cells)
+					{
+						state.mask[cell.i - state.top] |= (std::uint8_t)(1u << (cell.j - state.left));
+						auto& bottom = state.bottoms[cell.j - state.left];
+						bottom = std::max(bottom, cell.i);
+					}
+
+					for (auto& cell : cells)
+						cell = { cell.j, -cell.i };
+				}
+			}
+			return states;
+			}();
+
+		//KICKS[shape][rotation] are the pivot shifts tried in order when turning from the rotation to the next one
+		static constexpr auto KICKS = []() {
+			std::array<std::array<Kicks, STATES_NUMBER>, SHAPES_NUMBER> kicks{};
+			for (std::size_t shape = 0; shape < SHAPES_NUMBER; ++shape)
+			{
+				auto const& offsets = shape == (std::size_t)Shape::I ? I_OFFSETS
+					: shape == (std::size_t)Shape::O ? O_OFFSETS : COMMON_OFFSETS;
+
+				for (std::size_t from = 0; from < STATES_NUMBER; ++from)
+					for (std::size_t k = 0; k < KICKS_NUMBER; ++k)
+					{
+						auto const& a = offsets[from][k];
+						auto const& b = offsets[(from + 1) % STATES_NUMBER][k];
+						kicks[shape][from][k] = { -(a.j - b.j), a.i - b.i };
+					}
+			}
+			return kicks;
+			}();
+	};
+};
+
+//Occupancy is stored as one bitmask per row, so collision is a mask AND and a full row is a compare of its words.
+//Bit j + WALL_WIDTH is column j, the bits around the columns are walls and are always set.
+//The rows above the field are free and the rows below it are full, so no bounds checks are needed.
+//A row of the standard board is a single 16-bit word, wider ones are whole 128-bit vectors of 64-bit words
+template<std::uint32_t Width, std::uint32_t Height>
+struct BasicField
+{
+	using Pos = EngineBase::Pos;
+
+	static constexpr std::int32_t WALL_WIDTH = 3;
+	static constexpr std::int32_t HIDDEN_ROWS = 4;
+	static constexpr std::uint32_t CLEARED_FROM = 3;	//Spawn rows are never cleared
+
+	using Word = std::conditional_t<Width + 2 * WALL_WIDTH <= 16, std::uint16_t, std::uint64_t>;
+	static constexpr std::int32_t WORD_BITS = sizeof(Word) * 8;
+	static constexpr std::size_t WORDS = Width + 2 * WALL_WIDTH <= WORD_BITS ? 1 : (Width + 2 * WALL_WIDTH + 127) / 128 * 2;
+	static constexpr std::int32_t ROW_BITS = (std::int32_t)WORDS * WORD_BITS;	//The bits past the right wall are walls too
+
+	using Row = std::array<Word, WORDS>;
+	using Mask = std::array<Row, 4>;	//Tetramino occupancy, rows from the top one down
+
+	static constexpr Row FULL_ROW = []() {
+		Row row;
+		row.fill((Word)~Word{ 0 });
+		return row;
+		}();
+	static constexpr Row EMPTY_ROW = []() {
+		auto row = FULL_ROW;
+		for (std::int32_t j = 0; j < (std::int32_t)Width; ++j)
+			row[(j + WALL_WIDTH) / WORD_BITS] &= (Word)~((Word)1 << ((j + WALL_WIDTH) % WORD_BITS));
+		return row;
+		}();
+	static constexpr Row COLUMNS = []() {
+		Row row;
+		for (std::size_t k = 0; k < WORDS; ++k)
+			row[k] = (Word)~EMPTY_ROW[k];
+		return row;
+		}();
+
+	std::array<Row, HIDDEN_ROWS + Height + HIDDEN_ROWS> rows;
+	std::array<std::array<TileColor, Width>, Height> colors{};	//Valid for the taken tiles only
+	std::array<std::int32_t, Width> surface;	//Row of the top taken tile of every column, Height if there is none
+
+	BasicField();
+
+	static constexpr std::size_t wordOf(std::int32_t j) { return (std::size_t)((j + WALL_WIDTH) / WORD_BITS); }
+	static constexpr Word bitOf(std::int32_t j) { return (Word)((Word)1 << ((j + WALL_WIDTH) % WORD_BITS)); }
+	Row const& row(std::int32_t i) const { return rows[i + HIDDEN_ROWS]; }
+	bool isTaken(std::int32_t i, std::int32_t j) const { return row(i)[wordOf(j)] & bitOf(j); }
+	TileColor getColor(std::int32_t i, std::int32_t j) const { return isTaken(i, j) ? colors[i][j] : NONE; }
+	bool isFull(std::int32_t i) const;
+
+	void put(Pos const&, TileColor);
+	bool collides(std::int32_t top, Mask const&) const;
+	std::uint32_t clearLines();
+	std::uint32_t cascade();
+	bool raise(std::uint32_t count, std::int32_t hole, TileColor);
+	void updateSurface();
+};
+
+template<std::uint32_t Width, std::uint32_t Height>
+struct BasicTetramino : EngineBase
+{
+	using Field = BasicField<Width, Height>;
+
+	static constexpr Pos SPAWN_PIVOT{ 1, ((std::int32_t)Width - 1) / 2 };
+
+	//Properties
+	TileColor color;
+	Shape shape;
+	std::uint32_t rotation;
+	Pos pivot;
+	std::array<Pos, 4> tiles_pos;
+	std::array<Pos, 4> shadow;
+	std::uint32_t delay;
+	std::uint32_t slowDelay;
+	std::uint32_t fastDelay;
+	std::uint32_t fallTimer;	//Ticks passed since the last move down
+	bool isPlaced;
+
+	void update(Field const&, TetraminoPrototype const&, std::uint32_t delay);
+
+	//Moving
+	Events process_input(Field const&, MovingType);
+	void place(Pos const& pivot, std::uint32_t rotation);
+	void advancePos(Pos const&);
+	bool move(Field const&, Pos const&);
+	Events moveLeft(Field const&);
+	Events moveRight(Field const&);
+	void moveDown(Field const&);
+	Events rotate(Field const&);
+	Events fall();
+	void fast();
+	void slow();
+	void updateShadow(Field const&);
+
+	//Leaves the tetramino at the field
+	bool addToField(Field&) const;
+
+	//Help const functions
+	Rotations::State const& getState() const { return Rotations::STATES[(std::size_t)shape][rotation]; }
+	bool fitsAt(Field const&, Pos const& pivot, std::uint32_t rotation) const;
+	bool canMoveTowards(Field const&, Pos const&) const;
+	std::int32_t getDropDistance(Field const&) const;
+	std::array<Pos, 4> getBottom(Field const&) const;
+};
+
+//The game on a board of 'Width' columns and 'Height' rows
+template<std::uint32_t Width, std::uint32_t Height>
+class BasicEngine : public EngineBase
+{
+public:
+	static constexpr std::uint32_t GRID_NUMBER_J = Width;
+	static constexpr std::uint32_t GRID_NUMBER_I = Height;
+
+	using Field = BasicField<Width, Height>;
+	using Tetramino = BasicTetramino<Width, Height>;
+
+private:
+	//Engine objects
+	Field field{};
+	std::uint32_t seed;
+	std::uint32_t tickRate;
+	Gravity gravity;
+	std::uint64_t tick = 0;
+	std::uint64_t pieces = 0;
+	std::uint64_t lines = 0;
+	Random rd;
+	Random garbageRd;	//Holes of the garbage, the tetraminos do not depend on it
+	Tetramino tetramino{};
+	std::array<TetraminoPrototype, NEXT_NUMBER> next_tetraminos{};
+	bool isGame = true;
+
+	//Core member functions
+	TetraminoPrototype generatePrototype();
+	Events updateTetramino();
+	void updateNextTetraminos();
+	std::uint32_t clearLines();
+	bool checkForGameOver();
+
+public:
+	//The whole game as plain bytes, a few hundred of them for the standard board. The rows are the occupancy bits
+	//of the field and the colors are two in a byte, the tiles of the tetramino and its shadow are found again from its pivot
+	struct Snapshot {
+		std::array<typename Field::Row, Height> rows;
+		std::array<std::array<std::uint8_t, (Width + 1) / 2>, Height> colors;
+		std::uint64_t tick;
+		std::uint64_t pieces;
+		std::uint64_t lines;
+		Random rd;
+		Random garbageRd;
+		std::uint32_t seed;
+		std::uint32_t tickRate;
+		std::uint32_t delay;
+		std::uint32_t slowDelay;
+		std::uint32_t fastDelay;
+		std::uint32_t fallTimer;
+		std::int16_t pivotI;
+		std::int16_t pivotJ;
+		TileColor color;
+		Shape shape;
+		std::uint8_t rotation;
+		bool isPlaced;
+		std::array<TetraminoPrototype, NEXT_NUMBER> next;
+		Gravity gravity;
+		bool isGame;
+	};
+
+	explicit BasicEngine(std::uint32_t seed = std::random_device{}(), std::uint32_t tickRate = TICK_RATE, Gravity = Gravity::NAIVE);
+
+	//Applies the inputs in order and advances the game by one tick
+	Events step(std::span<MovingType const> inputs = {});
+
+	//Pushes the field up by the rows with a hole in the same column
+	Events addGarbage(std::uint32_t rows);
+
+	void save(Snapshot&) const;
+	void restore(Snapshot const&);
+
+	Field const& getField() const { return field; }
+	Tetramino const& getTetramino() const { return tetramino; }
+	std::array<TetraminoPrototype, NEXT_NUMBER> const& getNextTetraminos() const { return next_tetraminos; }
+	std::uint32_t getSeed() const { return seed; }
+	std::uint32_t getTickRate() const { return tickRate; }
+	Gravity getGravity() const { return gravity; }
+	std::uint64_t getTick() const { return tick; }	//Number of simulated ticks
+	std::uint64_t getPieces() const { return pieces; }	//Number of placed tetraminos
+	std::uint64_t getLines() const { return lines; }	//Number of cleared lines
+	bool isOver() const { return !isGame; }
+};
+
+//The standard board of the game, the frontend, the bot and the replays play on it
+using Engine = BasicEngine<10, 20>;
+
+//The sizes built into the engine's sources, the large boards are for experiments with the rules
+extern template struct BasicField<10, 20>;
+extern template struct BasicField<64, 128>;
+extern template struct BasicField<256, 512>;
+extern template struct BasicTetramino<10, 20>;
+extern template struct BasicTetramino<64, 128>;
+extern template struct BasicTetramino<256, 512>;
+extern template class BasicEngine<10, 20>;
+extern template class BasicEngine<64, 128>;
+extern template class BasicEngine<256, 512>;
@@ -0,0 +1,377 @@
+#include "Engine.h"
+
+#include <algorithm>
+#include <bit>
+#include <numeric>
+#include <vector>
+
+//Every x86-64 target has SSE2, the wide rows are compared 128 bits at a time with it
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define FIELD_SSE2 1
+#endif
+
+template<std::uint32_t Width, std::uint32_t Height>
+BasicField<Width, Height>::BasicField()
+{
+	std::ranges::fill(rows, EMPTY_ROW);
+	std::fill(rows.end() - HIDDEN_ROWS, rows.end(), FULL_ROW);
+	surface.fill(Height);
+}
+
+template<std::uint32_t Width, std::uint32_t Height>
+bool BasicField<Width, Height>::isFull(std::int32_t i) const
+{
+	auto const& r = row(i);
+	if constexpr (WORDS == 1)
+		return r[0] == FULL_ROW[0];
+	else
+	{
+#ifdef FIELD_SSE2
+		auto all = _mm_set1_epi32(-1);
+		for (std::size_t k = 0; k < WORDS; k += 2)
+			all = _mm_and_si128(all, _mm_loadu_si128((__m128i const*)&r[k]));
+		return _mm_movemask_epi8(_mm_cmpeq_epi32(all, _mm_set1_epi32(-1))) == 0xFFFF;
+#else
+		auto all = (Word)~Word{ 0 };
+		for (auto word : r)
+			all &= word;
+		return all == (Word)~Word{ 0 };
+#endif
+	}
+}
+
+template<std::uint32_t Width, std::uint32_t Height>
+void BasicField<Width, Height>::put(Pos const& pos, TileColor color)
+{
+	rows[pos.i + HIDDEN_ROWS][wordOf(pos.j)] |= bitOf(pos.j);
+	colors[pos.i][pos.j] = color;
+	surface[pos.j] = std::min(surface[pos.j], pos.i);
+}
+
+//The mask has to be inside the walls and 'top' has to be within the hidden rows
+template<std::uint32_t Width, std::uint32_t Height>
+bool BasicField<Width, Height>::collides(std::int32_t top, Mask const& mask) const
+{
+	auto const* r = &rows[top + HIDDEN_ROWS];
+	Word hit = 0;
+	for (std::size_t k = 0; k < WORDS; ++k)
+		hit |= (r[0][k] & mask[0][k]) | (r[1][k] & mask[1][k]) | (r[2][k] & mask[2][k]) | (r[3][k] & mask[3][k]);
+	return hit;
+}
+
+//Removes full rows from the bottom up. The rows under the lowest full one stay, every run of kept rows above it
+//is moved down at once. Returns the number of cleared lines
+template<std::uint32_t Width, std::uint32_t Height>
+std::uint32_t BasicField<Width, Height>::clearLines()
+{
+	auto cleared = [this](std::int32_t i) { return i >= (std::int32_t)CLEARED_FROM && isFull(i); };
+
+	std::int32_t src = Height - 1;
+	while (src >= 0 && !cleared(src))
+		--src;
+	if (src < 0)
+		return 0;
+
+	std::int32_t dst = src;	//The lowest row which is not filled yet
+	while (src >= 0)
+	{
+		if (cleared(src))
+		{
+			--src;
+			continue;
+		}
+
+		auto end = src + 1;
+		while (src >= 0 && !cleared(src))
+			--src;
+		std::copy_backward(rows.begin() + HIDDEN_ROWS + src + 1, rows.begin() + HIDDEN_ROWS + end, rows.begin() + HIDDEN_ROWS + dst + 1);
+		std::copy_backward(colors.begin() + src + 1, colors.begin() + end, colors.begin() + dst + 1);
+		dst -= end - (src + 1);
+	}
+
+	auto count = dst + 1;
+	std::fill_n(rows.begin() + HIDDEN_ROWS, count, EMPTY_ROW);
+	this->updateSurface();
+	return count;
+}
+
+//Full rows are emptied where they are, then every clump of tiles connected through their sides falls on its own
+//until it lands. Clumps are found with a union-find over the horizontal runs of taken tiles in every word of a row,
+//so it is proportional to the runs and not to the tiles. A clump is looked at again only when one under it fell.
+//Returns the number of lines cleared in the whole chain
+template<std::uint32_t Width, std::uint32_t Height>
+std::uint32_t BasicField<Width, Height>::cascade()
+{
+	struct Run {
+		std::int32_t i;
+		std::size_t word;
+		Word bits;
+		std::int32_t begin;	//Bits of the whole row, the runs of a row are in their order
+		std::int32_t end;
+	};
+	struct Clump {
+		std::size_t from;	//Runs in 'order', from the lowest row up
+		std::size_t to;
+		bool queued;
+	};
+	static constexpr auto NO_CLUMP = ~std::uint32_t{ 0 };
+
+	//Scratch of every thread, nothing is allocated once it has grown
+	thread_local std::vector<Run> runs;
+	thread_local std::vector<std::size_t> parent;
+	thread_local std::vector<std::size_t> rowStart;
+	thread_local std::vector<std::size_t> order;
+	thread_local std::vector<Clump> clumps;
+	thread_local std::vector<std::uint32_t> queue;
+	thread_local std::vector<std::uint32_t> owners;	//Clump of every tile
+	thread_local std::vector<std::uint32_t> below;	//Clump of the nearest tile under the row in every column
+	thread_local std::vector<std::uint32_t> waiting;	//Clumps under every clump which have not landed yet
+	thread_local std::vector<std::uint32_t> edgeStart;
+	thread_local std::vector<std::uint32_t> edges;	//Clumps above every clump
+
+	auto find = [](std::size_t r) {
+		while (parent[r] != r)
+			r = parent[r] = parent[parent[r]];
+		return r;
+		};
+	auto unite = [&find](std::size_t a, std::size_t b) {
+		a = find(a);
+		b = find(b);
+		if (a != b)
+			parent[std::max(a, b)] = std::min(a, b);
+		};
+
+	std::uint32_t total = 0;
+	while (true)
+	{
+		std::uint32_t cleared = 0;
+		for (std::int32_t i = CLEARED_FROM; i < (std::int32_t)Height; ++i)
+			if (isFull(i))
+			{
+				rows[i + HIDDEN_ROWS] = EMPTY_ROW;
+				++cleared;
+			}
+		if (!cleared)
+			break;
+		total += cleared;
+
+		runs.clear();
+		rowStart.resize(Height + 1);
+		for (std::int32_t i = 0; i < (std::int32_t)Height; ++i)
+		{
+			rowStart[i] = runs.size();
+			for (std::size_t k = 0; k < WORDS; ++k)
+				for (auto taken = (Word)(row(i)[k] & COLUMNS[k]); taken; )
+				{
+					//Adding the lowest bit carries through the run and clears it
+					auto low = (Word)(taken & (Word)(~taken + 1));
+					auto run = (Word)(taken & (Word)~(Word)(taken + low));
+					auto base = (std::int32_t)k * WORD_BITS;
+					runs.push_back({ i, k, run, base + std::countr_zero(run), base + (std::int32_t)std::bit_width(run) });
+					taken &= (Word)~run;
+				}
+		}
+		rowStart[Height] = runs.size();
+
+		parent.resize(runs.size());
+		std::iota(parent.begin(), parent.end(), std::size_t{ 0 });
+		for (std::uint32_t i = 0; i < Height; ++i)
+		{
+			//Runs of neighbouring words which touch
+			for (auto r = rowStart[i] + 1; r < rowStart[i + 1]; ++r)
+				if (runs[r - 1].end == runs[r].begin)
+					unite(r - 1, r);
+
+			//Runs of the row above which overlap, both rows are walked at once
+			if (!i)
+				continue;
+			for (auto a = rowStart[i - 1], b = rowStart[i]; a < rowStart[i] && b < rowStart[i + 1]; )
+			{
+				auto const& above = runs[a];
+				auto const& below = runs[b];
+				if (above.begin < below.end && below.begin < above.end)
+					unite(a, b);
+				if (above.end < below.end)
+					++a;
+				else
+					++b;
+			}
+		}
+
+		//Runs of a clump next to each other from its lowest row up, the clumps from the lowest one up
+		order.resize(runs.size());
+		std::iota(order.begin(), order.end(), std::size_t{ 0 });
+		for (auto& p : parent)
+			p = find(p);
+		std::ranges::sort(order, [](std::size_t a, std::size_t b) {
+			return parent[a] != parent[b] ? parent[a] < parent[b] : runs[a].i > runs[b].i;
+			}
+		);
+		clumps.clear();
+		for (std::size_t from = 0, to; from < order.size(); from = to)
+		{
+			for (to = from + 1; to < order.size() && parent[order[to]] == parent[order[from]]; ++to);
+			clumps.push_back({ from, to, true });
+		}
+		std::ranges::sort(clumps, std::greater{}, [](Clump const& clump) { return runs[order[clump.from]].i; });
+
+		auto column = [](Run const& run, Word bits) { return (std::int32_t)run.word * WORD_BITS + std::countr_zero(bits) - WALL_WIDTH; };
+		owners.assign(Width * Height, NO_CLUMP);
+		for (std::uint32_t c = 0; c < clumps.size(); ++c)
+			for (auto r : std::span(order).subspan(clumps[c].from, clumps[c].to - clumps[c].from))
+				for (auto bits = runs[r].bits; bits; bits &= bits - 1)
+					owners[runs[r].i * Width + column(runs[r], bits)] = c;
+
+		//A clump can land only on the nearest clumps under it in its columns, they are found from the bottom row up
+		auto forEachEdge = [&column](auto&& f) {
+			below.assign(Width, NO_CLUMP);
+			for (auto r = runs.size(); r--; )
+				for (auto bits = runs[r].bits; bits; bits &= bits - 1)
+				{
+					auto j = column(runs[r], bits);
+					auto c = owners[runs[r].i * Width + j];
+					if (below[j] != NO_CLUMP && below[j] != c)
+						f(below[j], c);
+					below[j] = c;
+				}
+			};
+		waiting.assign(clumps.size(), 0);
+		edgeStart.assign(clumps.size() + 1, 0);
+		forEachEdge([](std::uint32_t under, std::uint32_t c) {
+			++edgeStart[under + 1];
+			++waiting[c];
+			}
+		);
+		std::partial_sum(edgeStart.begin(), edgeStart.end(), edgeStart.begin());
+		edges.resize(edgeStart.back());
+		forEachEdge([](std::uint32_t under, std::uint32_t c) { edges[edgeStart[under]++] = c; });
+		std::shift_right(edgeStart.begin(), edgeStart.end(), 1);
+		edgeStart[0] = 0;
+
+		//Every clump is queued after the ones under it, so it falls once. Interlocked clumps lie on each other and go last,
+		//they fall in turns until they all land
+		queue.clear();
+		for (std::uint32_t c = 0; c < clumps.size(); ++c)
+			if (!waiting[c])
+				queue.push_back(c);
+		for (std::size_t head = 0; head < queue.size(); ++head)
+			for (auto e = edgeStart[queue[head]]; e < edgeStart[queue[head] + 1]; ++e)
+				if (!--waiting[edges[e]])
+					queue.push_back(edges[e]);
+		for (std::uint32_t c = 0; c < clumps.size(); ++c)
+			if (waiting[c])
+				queue.push_back(c);
+
+		//A clump which rests on one which falls later is queued again when that one falls
+		for (std::size_t head = 0; head < queue.size(); ++head)
+		{
+			auto c = queue[head];
+			auto& clump = clumps[c];
+			clump.queued = false;
+
+			//Most clumps still lie on another one or on the floor, which is found from the lowest runs without lifting them
+			auto clumpRuns = std::span(order).subspan(clump.from, clump.to - clump.from);
+			auto rests = [this, c, &column](Run const& run) {
+				if (run.i + 1 == (std::int32_t)Height)
+					return true;
+				for (auto bits = (Word)(rows[run.i + 1 + HIDDEN_ROWS][run.word] & run.bits); bits; bits &= bits - 1)
+					if (owners[(run.i + 1) * Width + column(run, bits)] != c)
+						return true;
+				return false;
+				};
+			if (std::ranges::any_of(clumpRuns, [&rests](std::size_t r) { return rests(runs[r]); }))
+				continue;
+
+			for (auto r : clumpRuns)
+				rows[runs[r].i + HIDDEN_ROWS][runs[r].word] &= (Word)~runs[r].bits;
+
+			std::int32_t drop = 0;
+			while (std::ranges::none_of(clumpRuns, [this, drop](std::size_t r) {
+				return rows[runs[r].i + drop + 1 + HIDDEN_ROWS][runs[r].word] & runs[r].bits;
+				}))
+				++drop;
+
+			if (drop)
+				for (auto r : clumpRuns)
+					for (auto bits = runs[r].bits; bits; bits &= bits - 1)
+					{
+						auto cell = runs[r].i * Width + column(runs[r], bits);
+						owners[cell] = NO_CLUMP;
+
+						//Whatever lay on the clump may fall now
+						auto above = runs[r].i ? owners[cell - Width] : NO_CLUMP;
+						if (above != NO_CLUMP && above != c && !clumps[above].queued)
+						{
+							clumps[above].queued = true;
+							queue.push_back(above);
+						}
+					}
+
+			//From the lowest row up, so no color of the clump is overwritten before it is moved
+			for (auto r : clumpRuns)
+			{
+				auto& run = runs[r];
+				if (drop)
+					for (auto bits = run.bits; bits; bits &= bits - 1)
+					{
+						auto j = column(run, bits);
+						colors[run.i + drop][j] = colors[run.i][j];
+						owners[(run.i + drop) * Width + j] = c;
+					}
+				run.i += drop;
+				rows[run.i + HIDDEN_ROWS][run.word] |= run.bits;
+			}
+		}
+	}
+
+	if (total)
+		this->updateSurface();
+	return total;
+}
+
+//Moves the rows up and fills the bottom ones with taken tiles but the hole.
+//Returns false if any taken tile was pushed out of the field
+template<std::uint32_t Width, std::uint32_t Height>
+bool BasicField<Width, Height>::raise(std::uint32_t count, std::int32_t hole, TileColor color)
+{
+	count = std::min(count, Height);
+	auto first = rows.begin() + HIDDEN_ROWS;
+	bool fits = std::all_of(first, first + count, [](Row const& r) { return r == EMPTY_ROW; });
+
+	std::copy(first + count, first + Height, first);
+	std::copy(colors.begin() + count, colors.end(), colors.begin());
+
+	auto garbage = FULL_ROW;
+	garbage[wordOf(hole)] &= (Word)~bitOf(hole);
+	std::fill(first + (Height - count), first + Height, garbage);
+	std::for_each(colors.end() - count, colors.end(), [color](auto& line) { line.fill(color); });
+
+	this->updateSurface();
+	return fits;
+}
+
+//Finds the top taken tile of every column, rows are scanned from the top until every column has one
+template<std::uint32_t Width, std::uint32_t Height>
+void BasicField<Width, Height>::updateSurface()
+{
+	surface.fill(Height);
+	Row covered{};
+	bool done = false;
+	for (std::int32_t i = 0; i < (std::int32_t)Height && !done; ++i)
+	{
+		done = true;
+		for (std::size_t k = 0; k < WORDS; ++k)
+		{
+			auto taken = (Word)(row(i)[k] & COLUMNS[k]);
+			for (auto top = (Word)(taken & ~covered[k]); top; top &= top - 1)
+				surface[k * WORD_BITS + std::countr_zero(top) - WALL_WIDTH] = i;
+			covered[k] |= taken;
+			done = done && covered[k] == COLUMNS[k];
+		}
+	}
+}
+
+template struct BasicField<10, 20>;
+template struct BasicField<64, 128>;
+template struct BasicField<256, 512>;
@@ -0,0 +1,89 @@
+#pragma once
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <array>
+
+#include "Engine.h"
+#include "TileBatch.hpp"
+
+//Locked tiles of the field kept on the GPU. Every cell has its own instance and a free cell is not drawn,
+//the rows which changed since the last update are the only ones uploaded again
+class FieldLayer
+{
+public:
+	static constexpr GLsizei ROW_INSTANCES = Engine::GRID_NUMBER_J;
+	static constexpr GLsizei INSTANCES = Engine::GRID_NUMBER_I * ROW_INSTANCES;
+
+private:
+	GLuint VAO;
+	GLuint instanceVBO;
+	std::array<TileBatch::Instance, INSTANCES> instances;	//What the GPU has
+
+	void upload(GLsizei fromRow, GLsizei toRow)
+	{
+		renderStats.bytesUploaded += (toRow - fromRow) * ROW_INSTANCES * sizeof(TileBatch::Instance);
+		glBufferSubData(GL_ARRAY_BUFFER, fromRow * ROW_INSTANCES * sizeof(TileBatch::Instance),
+			(toRow - fromRow) * ROW_INSTANCES * sizeof(TileBatch::Instance), &instances[fromRow * ROW_INSTANCES]);
+	}
+
+public:
+	//'origin' is the top-left corner of the field in the unscaled window pixels
+	FieldLayer(GLuint quadVBO, glm::vec2 const& origin, GLfloat tileSide)
+	{
+		for (GLsizei i = 0; i < (GLsizei)Engine::GRID_NUMBER_I; ++i)
+			for (GLsizei j = 0; j < ROW_INSTANCES; ++j)
+				instances[i * ROW_INSTANCES + j] = { origin.x + j * tileSide, origin.y + i * tileSide, NONE, 0, {} };
+
+		glGenBuffers(1, &instanceVBO);
+		glState.bindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(instances), instances.data(), GL_DYNAMIC_DRAW);
+		VAO = TileBatch::createVertexArray(quadVBO, instanceVBO);
+	}
+
+	~FieldLayer()
+	{
+		glState.deleteBuffer(instanceVBO);
+		glState.deleteVertexArray(VAO);
+	}
+
+	FieldLayer(FieldLayer const&) = delete;
+	FieldLayer& operator=(FieldLayer const&) = delete;
+
+	//Compares the field with the uploaded colors, neighbouring changed rows go in one upload
+	void update(Engine::Field const& field)
+	{
+		glState.bindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+
+		GLsizei dirtyFrom = -1;
+		for (GLsizei i = 0; i < (GLsizei)Engine::GRID_NUMBER_I; ++i)
+		{
+			bool dirty = false;
+			for (GLsizei j = 0; j < ROW_INSTANCES; ++j)
+			{
+				auto& instance = instances[i * ROW_INSTANCES + j];
+				auto color = (GLubyte)field.getColor(i, j);
+				dirty |= instance.color != color;
+				instance.color = color;
+			}
+
+			if (dirty && dirtyFrom < 0)
+				dirtyFrom = i;
+			else if (!dirty && dirtyFrom >= 0)
+			{
+				this->upload(dirtyFrom, i);
+				dirtyFrom = -1;
+			}
+		}
+		if (dirtyFrom >= 0)
+			this->upload(dirtyFrom, Engine::GRID_NUMBER_I);
+	}
+
+	//The tile shader has to be in use
+	void draw() const
+	{
+		++renderStats.drawCalls;
+		glState.bindVertexArray(VAO);
+		glDrawArraysInstanced(GL_TRIANGLES, 0, 6, INSTANCES);
+	}
+};
@@ -0,0 +1,31 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+
+//Turns the variable frame time into a whole number of fixed simulation ticks.
+//The simulation runs the same whatever the display rate is, late frames are caught up with several ticks
+class FixedTimestep
+{
+	double tick;
+	double lag = 0.;
+	std::uint32_t maxTicks;
+
+public:
+	//Catch-up is limited so a long stall does not freeze the game while the ticks are replayed
+	explicit FixedTimestep(std::uint32_t tickRate, std::uint32_t maxTicks = 10)
+		: tick(1. / tickRate), maxTicks(maxTicks)
+	{
+	}
+
+	//Adds the frame time and returns the number of ticks to run
+	std::uint32_t advance(double frameTime)
+	{
+		lag += frameTime;
+		auto ticks = (std::uint32_t)std::min(lag / tick, (double)maxTicks);
+		lag = std::min(lag - ticks * tick, tick);
+		return ticks;
+	}
+
+	//Part of the next tick which has already passed, used to interpolate between the last two ticks
+	float getAlpha() const { return (float)(lag / tick); }
+};
@@ -0,0 +1,189 @@
+#pragma once
+#include <glad/glad.h>
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+
+#include "RenderStats.hpp"
+
+//Last state given to OpenGL. Calls which would not change it are skipped and counted as elided in renderStats,
+//the others as state changes. There is one context, so there is one state. Once the state is set through it,
+//it has to be changed and the objects bound by it deleted through it only, or it would skip calls it must not
+class GlState
+{
+public:
+	static constexpr GLuint TEXTURE_UNITS = 16;
+
+private:
+	//Scalar and vector uniforms up to 4 components, compared bit for bit
+	using UniformValue = std::array<std::uint32_t, 4>;
+
+	GLuint program = 0;
+	GLuint vertexArray = 0;
+	GLuint arrayBuffer = 0;
+	GLuint uniformBuffer = 0;
+	GLuint activeUnit = 0;
+	std::array<GLuint, TEXTURE_UNITS> textures{};	//Of the unit's target, units hold a single texture here
+	bool blend = false;
+	GLenum blendSrc = GL_ONE;
+	GLenum blendDst = GL_ZERO;
+	bool scissor = false;
+	std::array<GLint, 4> scissorBox{};
+	std::unordered_map<std::uint64_t, UniformValue> uniforms;	//By the program and the location
+
+	static bool changed(GLuint& current, GLuint value)
+	{
+		if (current == value)
+		{
+			++renderStats.elidedCalls;
+			return false;
+		}
+		current = value;
+		++renderStats.stateChanges;
+		return true;
+	}
+
+	GLuint& bufferOf(GLenum target)
+	{
+		return target == GL_UNIFORM_BUFFER ? uniformBuffer : arrayBuffer;
+	}
+
+public:
+	void useProgram(GLuint id)
+	{
+		if (changed(program, id))
+			glUseProgram(id);
+	}
+
+	void bindVertexArray(GLuint id)
+	{
+		if (changed(vertexArray, id))
+			glBindVertexArray(id);
+	}
+
+	//GL_ARRAY_BUFFER and GL_UNIFORM_BUFFER, the element buffer is a part of the vertex array
+	void bindBuffer(GLenum target, GLuint id)
+	{
+		if (changed(bufferOf(target), id))
+			glBindBuffer(target, id);
+	}
+
+	//Binds the general point of the target as well
+	void bindBufferBase(GLenum target, GLuint index, GLuint id)
+	{
+		bufferOf(target) = id;
+		++renderStats.stateChanges;
+		glBindBufferBase(target, index, id);
+	}
+
+	void bindTexture(GLuint unit, GLenum target, GLuint id)
+	{
+		if (textures[unit] == id)
+		{
+			++renderStats.elidedCalls;
+			return;
+		}
+
+		if (changed(activeUnit, unit))
+			glActiveTexture(GL_TEXTURE0 + unit);
+		textures[unit] = id;
+		++renderStats.stateChanges;
+		glBindTexture(target, id);
+	}
+
+	void setBlend(GLenum src, GLenum dst)
+	{
+		if (blend && blendSrc == src && blendDst == dst)
+		{
+			++renderStats.elidedCalls;
+			return;
+		}
+
+		if (!blend)
+			glEnable(GL_BLEND);
+		glBlendFunc(src, dst);
+		blend = true;
+		blendSrc = src;
+		blendDst = dst;
+		++renderStats.stateChanges;
+	}
+
+	//Limits the draws to the box in the framebuffer's pixels
+	void setScissor(GLint x, GLint y, GLsizei width, GLsizei height)
+	{
+		std::array<GLint, 4> box{ x, y, width, height };
+		if (scissor && scissorBox == box)
+		{
+			++renderStats.elidedCalls;
+			return;
+		}
+
+		if (!scissor)
+			glEnable(GL_SCISSOR_TEST);
+		if (scissorBox != box)
+			glScissor(x, y, width, height);
+		scissor = true;
+		scissorBox = box;
+		++renderStats.stateChanges;
+	}
+
+	void disableScissor()
+	{
+		if (!scissor)
+		{
+			++renderStats.elidedCalls;
+			return;
+		}
+
+		glDisable(GL_SCISSOR_TEST);
+		scissor = false;
+		++renderStats.stateChanges;
+	}
+
+	//True if the uniform of the program in use has to be set to the value, which is then remembered
+	template<class T>
+	bool setsUniform(GLint location, T const& value)
+	{
+		static_assert(sizeof(T) <= sizeof(UniformValue), "Larger uniforms are not cached");
+
+		UniformValue bits{};
+		std::memcpy(bits.data(), &value, sizeof(T));
+
+		auto [it, inserted] = uniforms.try_emplace((std::uint64_t)program << 32 | (std::uint32_t)location, bits);
+		if (!inserted && it->second == bits)
+		{
+			++renderStats.elidedCalls;
+			return false;
+		}
+		it->second = bits;
+		++renderStats.stateChanges;
+		return true;
+	}
+
+	void deleteBuffer(GLuint id)
+	{
+		if (arrayBuffer == id)
+			arrayBuffer = 0;
+		if (uniformBuffer == id)
+			uniformBuffer = 0;
+		glDeleteBuffers(1, &id);
+	}
+
+	void deleteTexture(GLuint id)
+	{
+		for (auto& texture : textures)
+			if (texture == id)
+				texture = 0;
+		glDeleteTextures(1, &id);
+	}
+
+	void deleteVertexArray(GLuint id)
+	{
+		if (vertexArray == id)
+			vertexArray = 0;
+		glDeleteVertexArrays(1, &id);
+	}
+};
+inline GlState glState;
@@ -0,0 +1,85 @@
+#pragma once
+#include <glad/glad.h>
+
+#include <array>
+#include <cstdint>
+#include <memory>
+
+#include "Profiler.h"
+
+//GPU time of a part of the frame on a profiler track of its own. The timer queries are read a few frames later,
+//so the CPU never waits for them. A zone starts where the CPU issued it and lasts as long as the GPU took
+class GpuTimer
+{
+	static constexpr std::size_t LATENCY = 4;	//Frames a query has to be done in, or the frame is not measured
+
+	struct Query {
+		GLuint id;
+		std::uint64_t start = 0;	//CPU time of the begin
+		bool pending = false;
+	};
+
+	const char* name;
+	std::shared_ptr<Profiler::Track> track;
+	std::array<Query, LATENCY> queries;
+	std::size_t next = 0;
+	bool running = false;
+
+	//Pushes the result of the query if the GPU is done with it
+	bool collect(Query& query)
+	{
+		if (!query.pending)
+			return true;
+
+		GLint available = 0;
+		glGetQueryObjectiv(query.id, GL_QUERY_RESULT_AVAILABLE, &available);
+		if (!available)
+			return false;
+
+		GLuint64 elapsed;
+		glGetQueryObjectui64v(query.id, GL_QUERY_RESULT, &elapsed);
+		track->push({ name, query.start, query.start + elapsed });
+		query.pending = false;
+		return true;
+	}
+
+public:
+	explicit GpuTimer(const char* name)
+		: name(name), track(Profiler::makeTrack("GPU"))
+	{
+		for (auto& query : queries)
+			glGenQueries(1, &query.id);
+	}
+
+	~GpuTimer()
+	{
+		for (auto& query : queries)
+			glDeleteQueries(1, &query.id);
+	}
+
+	GpuTimer(GpuTimer const&) = delete;
+	GpuTimer& operator=(GpuTimer const&) = delete;
+
+	//Only one timer can run at a time, they do not nest
+	void begin()
+	{
+		auto& query = queries[next];
+		if (!Profiler::isEnabled() || !collect(query))
+			return;
+
+		query.start = Profiler::now();
+		glBeginQuery(GL_TIME_ELAPSED, query.id);
+		running = true;
+	}
+
+	void end()
+	{
+		if (!running)
+			return;
+
+		glEndQuery(GL_TIME_ELAPSED);
+		queries[next].pending = true;
+		next = (next + 1) % LATENCY;
+		running = false;
+	}
+};
@@ -0,0 +1,89 @@
+#pragma once
+#include <glad/glad.h>
+
+#include "RenderStats.hpp"
+
+//Layers which do not change between the frames, drawn once into a texture of the target's size.
+//Every frame starts with a copy of it, which is not blended and does not sample any texture
+class LayerCache
+{
+	GLuint framebuffer;
+	GLuint texture;
+	GLsizei width = 0;
+	GLsizei height = 0;
+	bool valid = false;
+
+public:
+	LayerCache()
+	{
+		glGenFramebuffers(1, &framebuffer);
+		glGenTextures(1, &texture);
+	}
+
+	~LayerCache()
+	{
+		glDeleteFramebuffers(1, &framebuffer);
+		glDeleteTextures(1, &texture);
+	}
+
+	LayerCache(LayerCache const&) = delete;
+	LayerCache& operator=(LayerCache const&) = delete;
+
+	bool isValid() const { return valid; }
+
+	//The layers are drawn again before the next frame
+	void invalidate()
+	{
+		valid = false;
+	}
+
+	void resize(GLsizei w, GLsizei h)
+	{
+		valid = false;
+		if (w == width && h == height)
+			return;
+
+		width = w;
+		height = h;
+
+		//The bindings are given back, the texture unit's one is tracked by glState
+		GLint boundTexture, boundFramebuffer;
+		glGetIntegerv(GL_TEXTURE_BINDING_2D, &boundTexture);
+		glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &boundFramebuffer);
+
+		glBindTexture(GL_TEXTURE_2D, texture);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+		glBindTexture(GL_TEXTURE_2D, (GLuint)boundTexture);
+
+		glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+		glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)boundFramebuffer);
+	}
+
+	//Draws go into the cache until end, over the clear color
+	void begin() const
+	{
+		++renderStats.stateChanges;
+		glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+		glClear(GL_COLOR_BUFFER_BIT);
+	}
+
+	void end(GLuint target)
+	{
+		++renderStats.stateChanges;
+		glBindFramebuffer(GL_FRAMEBUFFER, target);
+		valid = true;
+	}
+
+	//Copies the cache over the whole target, which is bound for drawing
+	void blit(GLuint target) const
+	{
+		renderStats.stateChanges += 2;
+		++renderStats.drawCalls;
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, framebuffer);
+		glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, target);
+	}
+};
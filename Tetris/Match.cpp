@@ -0,0 +1,94 @@
+#include "Match.h"
+
+#include <algorithm>
+
+Match::Match(std::size_t count, std::uint32_t seed, std::uint64_t dl, std::uint32_t tickRate, Engine::Gravity gravity)
+	: ends(count), delay(std::max<std::uint64_t>(dl, 1))
+{
+	players.reserve(count);
+	for (std::size_t k = 0; k < count; ++k)
+	{
+		auto& player = players.emplace_back(Player{ Engine(seed + (std::uint32_t)k, tickRate, gravity) });
+		player.target = (k + 1) % count;
+		ends[k].store(PLAYING, std::memory_order_relaxed);
+		for (std::size_t sender = 0; sender < count; ++sender)
+			player.inboxes.push_back(sender == k ? nullptr : std::make_unique<Inbox>());
+	}
+}
+
+//A board which was over at a later tick may not be seen yet by every thread, so it's still taken as playing
+bool Match::hasEnded(std::size_t player, std::uint64_t tick) const
+{
+	auto end = ends[player].load(std::memory_order_relaxed);
+	return end != PLAYING && end + delay <= tick;
+}
+
+//Garbage of the senders is taken in their order, every message is pushed up with its own hole
+Match::Events Match::receive(Player& player)
+{
+	Events events = Engine::NO_EVENT;
+	auto now = player.engine.getTick() + 1;
+	for (auto& inbox : player.inboxes)
+	{
+		if (!inbox)
+			continue;
+
+		for (auto const* garbage = inbox->front(); garbage && garbage->tick + delay <= now; garbage = inbox->front())
+		{
+			events |= player.engine.addGarbage(garbage->rows);
+			player.received += garbage->rows;
+			inbox->pop();
+		}
+	}
+	return events;
+}
+
+//The opponents which are still playing are attacked in turn, the rows are dropped when the queue of the target is full
+void Match::attack(std::size_t index, std::uint32_t lines)
+{
+	auto& player = players[index];
+	auto rows = ATTACK[std::min<std::size_t>(lines, ATTACK.size() - 1)];
+	if (!rows)
+		return;
+
+	auto tick = player.engine.getTick();
+	auto target = player.target;
+	std::size_t tries = 0;
+	for (; tries < players.size() && (target == index || this->hasEnded(target, tick)); ++tries)
+		target = (target + 1) % players.size();
+	if (tries == players.size())
+		return;
+
+	if (players[target].inboxes[index]->push({ tick, rows }))
+		player.sent += rows;
+	else
+		player.dropped += rows;
+	player.target = (target + 1) % players.size();
+}
+
+Match::Events Match::step(std::size_t index, std::span<MovingType const> inputs)
+{
+	auto& player = players[index];
+	if (player.engine.isOver())
+		return Engine::NO_EVENT;
+
+	auto tick = player.engine.getTick() + 1;
+	auto events = this->receive(player);
+	if (!player.engine.isOver())
+	{
+		auto lines = player.engine.getLines();
+		events |= player.engine.step(inputs);
+		if (events & Engine::LINE_CLEAR)
+			this->attack(index, (std::uint32_t)(player.engine.getLines() - lines));
+	}
+
+	//The garbage and the step end the game at the same tick
+	if (player.engine.isOver())
+		ends[index].store(tick, std::memory_order_relaxed);
+	return events;
+}
+
+bool Match::isOver() const
+{
+	return std::ranges::count_if(players, [](Player const& player) { return !player.engine.isOver(); }) <= 1;
+}
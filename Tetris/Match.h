@@ -0,0 +1,74 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "Engine.h"
+#include "SpscQueue.hpp"
+
+//Boards of one versus game, every board sends garbage rows to an opponent for the lines it clears.
+//Different boards may be stepped on different threads at once, the garbage goes through a lock-free queue
+//for every sender and receiver. A board takes the garbage which was sent 'delay' ticks ago or earlier, by default on
+//its next tick. When all the boards are stepped 'delay' ticks between two synchronizations the game is the same
+//on any number of threads, a larger delay lets them run longer rounds at the cost of later garbage
+class Match
+{
+public:
+	using Events = Engine::Events;
+	using MovingType = Engine::MovingType;
+
+	//Garbage rows sent for 0, 1, 2, 3 and 4 cleared lines
+	static constexpr std::array<std::uint32_t, 5> ATTACK{ 0, 0, 1, 2, 4 };
+	static constexpr std::uint64_t DELAY = 1;
+	static constexpr std::size_t INBOX_SIZE = 64;	//More than a board can send in a round
+	static constexpr std::uint64_t PLAYING = ~std::uint64_t{ 0 };
+
+	struct Garbage {
+		std::uint64_t tick;	//Tick of the sender it was sent at
+		std::uint32_t rows;
+	};
+
+private:
+	using Inbox = SpscQueue<Garbage, INBOX_SIZE>;
+
+	//Boards are stepped by different threads, so they do not share cache lines
+	struct alignas(64) Player {
+		Engine engine;
+		std::vector<std::unique_ptr<Inbox>> inboxes{};	//One for every sender, its own one is not used
+		std::size_t target = 0;	//Opponent of the next attack
+		std::uint64_t sent = 0;	//Garbage rows
+		std::uint64_t received = 0;
+		std::uint64_t dropped = 0;	//Rows which did not fit in the inbox of the opponent
+	};
+
+	std::vector<Player> players;
+	std::vector<std::atomic<std::uint64_t>> ends;	//Tick a board was over at, it's read by the other boards 'delay' ticks later
+	std::uint64_t delay;
+
+	bool hasEnded(std::size_t player, std::uint64_t tick) const;
+	Events receive(Player&);
+	void attack(std::size_t player, std::uint32_t lines);
+
+public:
+	//Board k is played with the seed + k
+	Match(std::size_t players, std::uint32_t seed, std::uint64_t delay = DELAY, std::uint32_t tickRate = Engine::TICK_RATE,
+		Engine::Gravity gravity = Engine::Gravity::NAIVE);
+
+	//Takes the garbage which is due, then applies the inputs and advances the board by one tick.
+	//Only one thread may step a board at once
+	Events step(std::size_t player, std::span<MovingType const> inputs = {});
+
+	//At most one board is still playing, call it when no board is being stepped
+	bool isOver() const;
+
+	std::size_t size() const { return players.size(); }
+	std::uint64_t getDelay() const { return delay; }
+	Engine const& getEngine(std::size_t player) const { return players[player].engine; }
+	std::uint64_t getSent(std::size_t player) const { return players[player].sent; }
+	std::uint64_t getReceived(std::size_t player) const { return players[player].received; }
+	std::uint64_t getDropped(std::size_t player) const { return players[player].dropped; }
+};
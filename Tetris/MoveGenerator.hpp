@@ -0,0 +1,220 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "Engine.h"
+
+//Finds every place a tetramino can lock at and the shortest inputs which take it there, tucks under overhangs and
+//spins through the kicks included. A breadth-first search goes over the (rotation, row, column) states from the spawn,
+//so the first inputs which reach a state are the shortest ones. The storage is made at construction, a search allocates nothing
+template<std::uint32_t Width, std::uint32_t Height>
+class BasicMoveGenerator
+{
+public:
+	using Field = BasicField<Width, Height>;
+	using Tetramino = BasicTetramino<Width, Height>;
+	using Pos = EngineBase::Pos;
+	using Rotations = EngineBase::Rotations;
+
+	//LEFT, RIGHT, ROTATE and DROP are the engine's LEFT, RIGHT, ROTATE and FALL
+	enum class Move : std::uint8_t
+	{
+		LEFT,
+		RIGHT,
+		ROTATE,
+		DOWN,	//One row down without locking, a tick of the gravity
+		DROP	//Falls to the bottom and locks
+	};
+
+	struct Placement {
+		Pos pivot;	//Where the tetramino locks
+		std::uint32_t rotation;
+		std::uint32_t inputs;	//Moves of the shortest path, the drop included
+		std::uint32_t from;		//State the tetramino is dropped from
+	};
+
+private:
+	//The pivot is always one of the cells, so a tetramino which fits has it inside the field or the rows above it
+	static constexpr std::int32_t TOP_ROW = -Field::HIDDEN_ROWS;
+	static constexpr std::uint32_t ROWS = Height + Field::HIDDEN_ROWS;
+	static constexpr std::uint32_t STATES = (std::uint32_t)Rotations::STATES_NUMBER * ROWS * Width;
+	static constexpr std::uint32_t NO_STATE = ~std::uint32_t{ 0 };
+
+	//ALIASES[shape][rotation] is the first rotation which covers the same cells and the pivot shift to it,
+	//so the symmetrical tetraminos report a place once
+	struct Alias {
+		std::uint32_t rotation;
+		Pos shift;
+	};
+	static constexpr auto ALIASES = []() {
+		std::array<std::array<Alias, Rotations::STATES_NUMBER>, EngineBase::SHAPES_NUMBER> aliases{};
+		auto sorted = [](std::array<Pos, 4> cells) {
+			std::ranges::sort(cells, {}, [](Pos const& pos) { return pos.i * 8 + pos.j; });
+			return cells;
+			};
+		for (std::size_t shape = 0; shape < EngineBase::SHAPES_NUMBER; ++shape)
+			for (std::uint32_t rotation = 0; rotation < Rotations::STATES_NUMBER; ++rotation)
+			{
+				aliases[shape][rotation] = { rotation, { 0, 0 } };
+				auto cells = sorted(Rotations::STATES[shape][rotation].cells);
+				for (std::uint32_t first = 0; first < rotation; ++first)
+				{
+					auto other = sorted(Rotations::STATES[shape][first].cells);
+					Pos shift{ cells[0].i - other[0].i, cells[0].j - other[0].j };
+					if (std::ranges::equal(cells, other, {}, {}, [&shift](Pos const& pos) { return Pos{ pos.i + shift.i, pos.j + shift.j }; }))
+					{
+						aliases[shape][rotation] = { first, shift };
+						break;
+					}
+				}
+			}
+		return aliases;
+		}();
+
+	using Bits = std::vector<std::uint64_t>;
+
+	Tetramino probe{};	//Its shape is the searched one, it's put at the states to test them
+	std::int32_t clearRows;	//Rows above the highest taken tile, only the walls are in the way there
+	Bits visited;
+	Bits tested;	//States which were checked against the field, 'fitting' is valid for them
+	Bits fitting;
+	Bits landed;	//Places which are reported, by the first rotation of the same cells
+	std::vector<std::uint32_t> queue;
+	std::vector<std::uint32_t> parent;
+	std::vector<std::uint32_t> distance;
+	std::vector<Move> moves;	//Move which reached the state
+	std::vector<Placement> placements;
+
+	static bool test(Bits const& bits, std::uint32_t k) { return bits[k / 64] >> (k % 64) & 1; }
+	static void set(Bits& bits, std::uint32_t k) { bits[k / 64] |= std::uint64_t{ 1 } << (k % 64); }
+
+	static std::uint32_t index(Pos const& pivot, std::uint32_t rotation)
+	{
+		return (rotation * ROWS + (std::uint32_t)(pivot.i - TOP_ROW)) * Width + (std::uint32_t)pivot.j;
+	}
+	static Pos pivotOf(std::uint32_t state)
+	{
+		return { (std::int32_t)(state / Width % ROWS) + TOP_ROW, (std::int32_t)(state % Width) };
+	}
+	static std::uint32_t rotationOf(std::uint32_t state) { return state / (ROWS * Width); }
+
+	//Index of the state if the tetramino fits there, every state is checked against the field once
+	std::uint32_t fit(Field const& field, Pos const& pivot, std::uint32_t rotation)
+	{
+		if (pivot.i < TOP_ROW || pivot.i >= (std::int32_t)Height || pivot.j < 0 || pivot.j >= (std::int32_t)Width)
+			return NO_STATE;
+
+		auto state = index(pivot, rotation);
+		if (!test(tested, state))
+		{
+			set(tested, state);
+			auto const& cells = Rotations::STATES[(std::size_t)probe.shape][rotation];
+			auto fits = pivot.i + std::ranges::max(cells.bottoms) < clearRows
+				? pivot.i + cells.top >= -Field::HIDDEN_ROWS && pivot.j + cells.left >= 0 && pivot.j + cells.left + cells.width <= (std::int32_t)Width
+				: probe.fitsAt(field, pivot, rotation);
+			if (fits)
+				set(fitting, state);
+		}
+		return test(fitting, state) ? state : NO_STATE;
+	}
+
+	void enqueue(std::uint32_t state, std::uint32_t from, Move move)
+	{
+		if (state == NO_STATE || test(visited, state))
+			return;
+
+		set(visited, state);
+		parent[state] = from;
+		moves[state] = move;
+		distance[state] = distance[from] + 1;
+		queue.push_back(state);
+	}
+
+	//Reports where the tetramino falls from the state unless the place is already reported
+	void land(Field const& field, std::uint32_t state)
+	{
+		auto rotation = rotationOf(state);
+		probe.pivot = pivotOf(state);
+		probe.rotation = rotation;
+		Pos pivot{ probe.pivot.i + probe.getDropDistance(field), probe.pivot.j };
+
+		auto const& alias = ALIASES[(std::size_t)probe.shape][rotation];
+		auto place = index({ pivot.i + alias.shift.i, pivot.j + alias.shift.j }, alias.rotation);
+		if (test(landed, place))
+			return;
+
+		set(landed, place);
+		placements.push_back({ pivot, rotation, distance[state] + 1, state });
+	}
+
+public:
+	BasicMoveGenerator()
+		: visited((STATES + 63) / 64), tested(visited.size()), fitting(visited.size()), landed(visited.size()),
+		parent(STATES), distance(STATES), moves(STATES)
+	{
+		queue.reserve(STATES);
+		placements.reserve(STATES);
+	}
+
+	//Every distinct place the tetramino locks at from where it is now, in the order of their shortest paths
+	std::span<Placement const> generate(Field const& field, Tetramino const& tetramino)
+	{
+		std::ranges::fill(visited, 0);
+		std::ranges::fill(tested, 0);
+		std::ranges::fill(fitting, 0);
+		std::ranges::fill(landed, 0);
+		queue.clear();
+		placements.clear();
+
+		probe.shape = tetramino.shape;
+		clearRows = std::ranges::min(field.surface);
+		auto start = this->fit(field, tetramino.pivot, tetramino.rotation);
+		if (start == NO_STATE)
+			return {};
+
+		set(visited, start);
+		parent[start] = start;
+		distance[start] = 0;
+		queue.push_back(start);
+		for (std::size_t head = 0; head < queue.size(); ++head)
+		{
+			auto state = queue[head];
+			auto pivot = pivotOf(state);
+			auto rotation = rotationOf(state);
+
+			//A state reached by moving down falls where the one above it does, which is nearer to the spawn
+			if (state == start || moves[state] != Move::DOWN)
+				this->land(field, state);
+
+			this->enqueue(this->fit(field, { pivot.i, pivot.j - 1 }, rotation), state, Move::LEFT);
+			this->enqueue(this->fit(field, { pivot.i, pivot.j + 1 }, rotation), state, Move::RIGHT);
+
+			//The engine turns at the first kick which fits, so only that one is a move
+			auto next = (rotation + 1) % Rotations::STATES_NUMBER;
+			for (auto const& kick : Rotations::KICKS[(std::size_t)tetramino.shape][rotation])
+				if (auto turned = this->fit(field, { pivot.i + kick.i, pivot.j + kick.j }, next); turned != NO_STATE)
+				{
+					this->enqueue(turned, state, Move::ROTATE);
+					break;
+				}
+
+			this->enqueue(this->fit(field, { pivot.i + 1, pivot.j }, rotation), state, Move::DOWN);
+		}
+		return placements;
+	}
+
+	//Writes the moves which take the tetramino to the placement, 'out' has to hold 'placement.inputs' of them
+	void getPath(Placement const& placement, std::span<Move> out) const
+	{
+		out[placement.inputs - 1] = Move::DROP;
+		for (auto k = placement.inputs - 1, state = placement.from; k--; state = parent[state])
+			out[k] = moves[state];
+	}
+};
+
+//Searches the placements on the standard board
+using MoveGenerator = BasicMoveGenerator<10, 20>;
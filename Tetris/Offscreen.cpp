@@ -0,0 +1,137 @@
+#include "Offscreen.h"
+
+#include <EGL/eglext.h>
+
+#include <cstring>
+#include <iostream>
+
+//The surfaceless platform needs no display server, the default display is tried when it's missing
+EGLDisplay Offscreen::getDisplay()
+{
+	const char* extensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+	if (extensions && std::strstr(extensions, "EGL_MESA_platform_surfaceless"))
+	{
+		auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+		if (getPlatformDisplay)
+			if (auto display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr); display != EGL_NO_DISPLAY)
+				return display;
+	}
+	return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+}
+
+bool Offscreen::init_context()
+{
+	display = getDisplay();
+	if (display == EGL_NO_DISPLAY || !eglInitialize(display, nullptr, nullptr))
+	{
+		std::cerr << "Failed to initialize EGL" << std::endl;
+		return false;
+	}
+
+	constexpr EGLint configAttributes[] = {
+		EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+		EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+		EGL_NONE
+	};
+	EGLConfig config;
+	EGLint configs = 0;
+	if (!eglChooseConfig(display, configAttributes, &config, 1, &configs) || !configs || !eglBindAPI(EGL_OPENGL_API))
+	{
+		std::cerr << "No EGL config for desktop OpenGL" << std::endl;
+		return false;
+	}
+
+	constexpr EGLint contextAttributes[] = {
+		EGL_CONTEXT_MAJOR_VERSION, 3,
+		EGL_CONTEXT_MINOR_VERSION, 3,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+		EGL_NONE
+	};
+	context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+	if (context == EGL_NO_CONTEXT)
+	{
+		std::cerr << "Failed to create an OpenGL 3.3 context" << std::endl;
+		return false;
+	}
+
+	//Without EGL_KHR_surfaceless_context the context needs some surface, the frames still go to the framebuffer object
+	if (!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+	{
+		constexpr EGLint surfaceAttributes[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+		surface = eglCreatePbufferSurface(display, config, surfaceAttributes);
+		if (surface == EGL_NO_SURFACE || !eglMakeCurrent(display, surface, surface, context))
+		{
+			std::cerr << "Failed to make the OpenGL context current" << std::endl;
+			return false;
+		}
+	}
+
+	if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress))
+	{
+		std::cerr << "Failed to initialize GLAD" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool Offscreen::init_framebuffer()
+{
+	glGenFramebuffers(1, &framebuffer);
+	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+
+	glGenRenderbuffers(1, &colorbuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, colorbuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorbuffer);
+
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		std::cerr << "Framebuffer is not complete" << std::endl;
+		return false;
+	}
+
+	glViewport(0, 0, width, height);
+	return true;
+}
+
+Offscreen::Offscreen(GLsizei width, GLsizei height)
+	: width(width), height(height)
+{
+	ready = this->init_context() && this->init_framebuffer();
+}
+
+Offscreen::~Offscreen()
+{
+	if (framebuffer)
+	{
+		glDeleteFramebuffers(1, &framebuffer);
+		glDeleteRenderbuffers(1, &colorbuffer);
+	}
+
+	if (display == EGL_NO_DISPLAY)
+		return;
+
+	eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+	if (surface != EGL_NO_SURFACE)
+		eglDestroySurface(display, surface);
+	if (context != EGL_NO_CONTEXT)
+		eglDestroyContext(display, context);
+	eglTerminate(display);
+}
+
+const char* Offscreen::getRenderer() const
+{
+	return ready ? (const char*)glGetString(GL_RENDERER) : "";
+}
+
+void Offscreen::finish() const
+{
+	glFinish();
+}
+
+std::vector<std::uint8_t> Offscreen::readPixels() const
+{
+	std::vector<std::uint8_t> pixels((std::size_t)width * height * 4);
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+	return pixels;
+}
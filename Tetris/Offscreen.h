@@ -0,0 +1,40 @@
+#pragma once
+#include <glad/glad.h>
+#include <EGL/egl.h>
+
+#include <cstdint>
+#include <vector>
+
+//OpenGL 3.3 core context without a window or a display, made through EGL. Mesa gives it on its surfaceless
+//platform with llvmpipe, so it works on machines without a GPU. The frames are drawn into a framebuffer object
+class Offscreen
+{
+	EGLDisplay display = EGL_NO_DISPLAY;
+	EGLContext context = EGL_NO_CONTEXT;
+	EGLSurface surface = EGL_NO_SURFACE;	//Only made when the context cannot be current without one
+	GLuint framebuffer = 0;
+	GLuint colorbuffer = 0;
+	GLsizei width;
+	GLsizei height;
+	bool ready = false;
+
+	static EGLDisplay getDisplay();
+	bool init_context();
+	bool init_framebuffer();
+
+public:
+	Offscreen(GLsizei width, GLsizei height);
+	~Offscreen();
+
+	Offscreen(Offscreen const&) = delete;
+	Offscreen& operator=(Offscreen const&) = delete;
+
+	//False if there is no context, the reason is reported
+	bool isReady() const { return ready; }
+	const char* getRenderer() const;
+
+	//Waits for the frame to be drawn
+	void finish() const;
+	//RGBA rows from the bottom one up
+	std::vector<std::uint8_t> readPixels() const;
+};
@@ -0,0 +1,45 @@
+//Offline asset packer: tetris_pack [bundle path]
+//Run from the directory the game runs from, the resources are found the same way
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+#include <irrKlang.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+#include "Packer.h"
+
+int main(int argc, char* argv[])
+{
+	const char* path = argc > 1 ? argv[1] : Packer::BUNDLE_PATH;
+
+	//Sounds are only decoded, no audio device is needed
+	auto* sEngine = irrklang::createIrrKlangDevice(irrklang::ESOD_NULL);
+	if (!sEngine)
+	{
+		std::cerr << "Failed to initialize sound engine" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	auto bytes = Packer::pack(*sEngine);
+	sEngine->drop();
+
+	std::ofstream ofs(path, std::ios::binary);
+	ofs.write((const char*)bytes.data(), bytes.size());
+	if (!ofs)
+	{
+		std::cerr << "Failed to write the bundle " << path << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	auto bundle = Bundle::fromMemory(std::move(bytes));
+	for (auto const& entry : bundle->getEntries())
+		std::cout << entry.name.data() << ": " << entry.size << " bytes" << std::endl;
+
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+	std::cout << "Packed " << path << " in " << elapsed.count() << " ms" << std::endl;
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,96 @@
+#include "Packer.h"
+
+#include <irrKlang.h>
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+#include "stb_image.h"
+
+static void writeU16(std::vector<std::uint8_t>& data, std::uint16_t value)
+{
+	data.push_back((std::uint8_t)value);
+	data.push_back((std::uint8_t)(value >> 8));
+}
+
+static void writeU32(std::vector<std::uint8_t>& data, std::uint32_t value)
+{
+	writeU16(data, (std::uint16_t)value);
+	writeU16(data, (std::uint16_t)(value >> 16));
+}
+
+//Wraps the samples into a PCM WAV file, which the sound engine takes without decoding
+static std::vector<std::uint8_t> makeWav(irrklang::SAudioStreamFormat const& format, std::uint8_t const* samples)
+{
+	auto dataSize = (std::uint32_t)format.getSampleDataSize();
+
+	std::vector<std::uint8_t> wav{ 'R', 'I', 'F', 'F' };
+	writeU32(wav, 36 + dataSize);
+	wav.insert(wav.end(), { 'W', 'A', 'V', 'E', 'f', 'm', 't', ' ' });
+	writeU32(wav, 16);
+	writeU16(wav, 1);	//PCM
+	writeU16(wav, (std::uint16_t)format.ChannelCount);
+	writeU32(wav, (std::uint32_t)format.SampleRate);
+	writeU32(wav, (std::uint32_t)format.getBytesPerSecond());
+	writeU16(wav, (std::uint16_t)format.getFrameSize());
+	writeU16(wav, (std::uint16_t)(format.getSampleSize() * 8));
+	wav.insert(wav.end(), { 'd', 'a', 't', 'a' });
+	writeU32(wav, dataSize);
+	wav.insert(wav.end(), samples, samples + dataSize);
+	return wav;
+}
+
+bool Packer::addImage(Bundle::Writer& writer, ImageResource const& resource)
+{
+	//Rows go from the bottom one up, as OpenGL takes them
+	int width;
+	int height;
+	stbi_set_flip_vertically_on_load(true);
+	auto* pixels = stbi_load(resource.path, &width, &height, nullptr, 4);
+	if (!pixels)
+		return false;
+
+	writer.addImage(resource.name, pixels, (std::uint32_t)width, (std::uint32_t)height, resource.layers);
+	stbi_image_free(pixels);
+	return true;
+}
+
+bool Packer::addSound(Bundle::Writer& writer, irrklang::ISoundEngine& sEngine, SoundResource const& resource)
+{
+	if (!resource.decode)
+	{
+		std::ifstream ifs(resource.path, std::ios::binary);
+		if (!ifs)
+			return false;
+
+		std::vector<std::uint8_t> file{ std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>() };
+		writer.addSound(resource.name, file);
+		return true;
+	}
+
+	auto* source = sEngine.addSoundSourceFromFile(resource.path, irrklang::ESM_NO_STREAMING, true);
+	if (!source || !source->getSampleData())
+		return false;
+
+	writer.addSound(resource.name, makeWav(source->getAudioFormat(), (std::uint8_t const*)source->getSampleData()));
+	sEngine.removeSoundSource(source);
+	return true;
+}
+
+std::vector<std::uint8_t> Packer::pack(irrklang::ISoundEngine& sEngine)
+{
+	Bundle::Writer writer;
+	for (auto const& texture : TEXTURES)
+		if (!addImage(writer, texture))
+			std::cerr << "Failed to load texture " << texture.path << std::endl;
+
+	if (!addImage(writer, ICON))
+		std::cerr << "Failed to load icon " << ICON.path << std::endl;
+
+	for (auto const& sound : SOUNDS)
+		if (!addSound(writer, sEngine, sound))
+			std::cerr << "Failed to load sound " << sound.path << std::endl;
+
+	return writer.finish();
+}
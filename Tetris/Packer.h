@@ -0,0 +1,55 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "Bundle.h"
+#include "Engine.h"
+
+namespace irrklang { class ISoundEngine; }
+
+//Decodes the game resources into a bundle: images into RGBA mipmaps and texture arrays, sound effects into PCM.
+//tetris_pack does it once offline, the game does it at startup only when there is no bundle
+class Packer
+{
+public:
+	static constexpr const char* BUNDLE_PATH = "resources/assets.pak";
+
+	struct ImageResource {
+		const char* path;
+		const char* name;
+		std::uint32_t layers;	//Side by side in the image
+	};
+
+	struct SoundResource {
+		const char* path;
+		const char* name;
+		bool decode;	//Streamed sounds are kept compressed
+	};
+
+	//In the order of Renderer::Textures
+	static constexpr std::array<ImageResource, 3> TEXTURES{ {
+			{ "resources/tiles.png", "tiles", COLORS_END },
+			{ "resources/frame.png", "frame", 1 },
+			{ "resources/background.png", "background", 1 }
+		} };
+	static constexpr ImageResource ICON{ "resources/Icon.png", "icon", 1 };
+
+	//In the order of Audio::Sound
+	static constexpr std::array<SoundResource, 6> SOUNDS{ {
+			{ "resources/soundtrack.mp3", "soundtrack.mp3", false },
+			{ "resources/line_clear.wav", "line_clear.wav", true },
+			{ "resources/end_game.wav", "end_game.wav", true },
+			{ "resources/fall.wav", "fall.wav", true },
+			{ "resources/rotate.wav", "rotate.wav", true },
+			{ "resources/move.wav", "move.wav", true }
+		} };
+
+private:
+	static bool addImage(Bundle::Writer&, ImageResource const&);
+	static bool addSound(Bundle::Writer&, irrklang::ISoundEngine&, SoundResource const&);
+
+public:
+	//Resources which fail to load are reported and left out
+	static std::vector<std::uint8_t> pack(irrklang::ISoundEngine&);
+};
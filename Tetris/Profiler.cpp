@@ -0,0 +1,106 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <vector>
+
+std::atomic<bool> Profiler::enabled{ false };
+
+//Tracks are shared with the registry, so the zones of a finished thread are still dumped
+static std::mutex registryMutex;
+static std::vector<std::shared_ptr<Profiler::Track>> registry;
+
+std::uint64_t Profiler::now()
+{
+	return (std::uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+std::shared_ptr<Profiler::Track> Profiler::makeTrack(std::string name)
+{
+	std::lock_guard lock(registryMutex);
+	auto id = (std::uint32_t)registry.size() + 1;
+	if (name.empty())
+		name = "thread " + std::to_string(id);
+	return registry.emplace_back(std::make_shared<Track>(std::move(name), id));
+}
+
+Profiler::Track& Profiler::threadTrack()
+{
+	thread_local std::shared_ptr<Track> track = makeTrack({});
+	return *track;
+}
+
+void Profiler::nameThread(std::string name)
+{
+	auto& track = threadTrack();
+	std::lock_guard lock(registryMutex);
+	track.name = std::move(name);
+}
+
+//Copies what the rings hold now. An event the owner overwrote while it was copied is left out
+bool Profiler::dump(const char* path)
+{
+	struct Copy {
+		std::string name;
+		std::uint32_t id;
+		std::vector<Event> events;
+	};
+
+	std::vector<Copy> copies;
+	{
+		std::lock_guard lock(registryMutex);
+		for (auto const& track : registry)
+		{
+			auto end = track->count.load(std::memory_order_acquire);
+			auto begin = end > CAPACITY ? end - CAPACITY : 0;
+
+			Copy copy{ track->name, track->id, {} };
+			copy.events.reserve(end - begin);
+			for (auto i = begin; i < end; ++i)
+				copy.events.push_back(track->events[i & (CAPACITY - 1)]);
+
+			//Slots below the count minus the capacity may have been written again since
+			auto written = track->count.load(std::memory_order_acquire);
+			auto valid = written > CAPACITY ? written - CAPACITY : 0;
+			if (valid > begin)
+				copy.events.erase(copy.events.begin(), copy.events.begin() + (std::ptrdiff_t)std::min(valid - begin, end - begin));
+			copies.push_back(std::move(copy));
+		}
+	}
+
+	//Times start at the earliest event, in microseconds as the format wants
+	std::uint64_t origin = UINT64_MAX;
+	for (auto const& copy : copies)
+		for (auto const& event : copy.events)
+			origin = std::min(origin, event.start);
+
+	std::ofstream file(path);
+	if (!file)
+		return false;
+
+	file << std::fixed << std::setprecision(3);
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	bool first = true;
+	auto separate = [&]() {
+		file << (first ? "\n" : ",\n");
+		first = false;
+		};
+	for (auto const& copy : copies)
+	{
+		separate();
+		file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << copy.id << ",\"args\":{\"name\":\"" << copy.name << "\"}}";
+		for (auto const& event : copy.events)
+		{
+			separate();
+			file << "{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << copy.id
+				<< ",\"ts\":" << (event.start - origin) / 1000.
+				<< ",\"dur\":" << (event.end - event.start) / 1000. << "}";
+		}
+	}
+	file << "\n]}\n";
+	return (bool)file;
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+//Scoped timing zones kept in a ring buffer per thread and written out as a Chrome trace (chrome://tracing, Perfetto).
+//The rings always hold the last CAPACITY zones of every thread, so a capture can be dumped at any moment.
+//Disabled zones cost a relaxed load, enabled ones two clock reads and a store into the thread's own ring
+class Profiler
+{
+public:
+	static constexpr std::size_t CAPACITY = 1 << 14;	//Zones kept per thread
+
+	struct Event {
+		const char* name;		//Has to outlive the profiler, a string literal
+		std::uint64_t start;	//Nanoseconds of the steady clock
+		std::uint64_t end;
+	};
+
+	//Events of one thread or of a timeline of its own like the GPU one. Written by a single thread,
+	//read while it's written when dumped
+	class Track
+	{
+		friend class Profiler;
+
+		std::string name;
+		std::uint32_t id;
+		std::unique_ptr<Event[]> events{ new Event[CAPACITY] };
+		std::atomic<std::uint64_t> count{ 0 };	//Events pushed so far, the ring keeps the last CAPACITY of them
+
+	public:
+		Track(std::string name, std::uint32_t id) : name(std::move(name)), id(id) {}
+
+		void push(Event const& event)
+		{
+			auto c = count.load(std::memory_order_relaxed);
+			events[c & (CAPACITY - 1)] = event;
+			count.store(c + 1, std::memory_order_release);
+		}
+	};
+
+	class Zone
+	{
+		const char* name;
+		std::uint64_t start;	//0 if the profiler was disabled when the zone began
+
+	public:
+		explicit Zone(const char* name) : name(name), start(isEnabled() ? now() : 0) {}
+		~Zone()
+		{
+			if (start)
+				threadTrack().push({ name, start, now() });
+		}
+
+		Zone(Zone const&) = delete;
+		Zone& operator=(Zone const&) = delete;
+	};
+
+private:
+	static std::atomic<bool> enabled;
+
+public:
+	static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+	static void setEnabled(bool on) { enabled.store(on, std::memory_order_relaxed); }
+	static std::uint64_t now();
+
+	//The calling thread's track, made on the first use
+	static Track& threadTrack();
+	static void nameThread(std::string name);
+	//Timeline which is not a thread, its events are pushed by one thread only
+	static std::shared_ptr<Track> makeTrack(std::string name);
+
+	//Writes every track as Chrome trace JSON, false if the file cannot be written
+	static bool dump(const char* path);
+};
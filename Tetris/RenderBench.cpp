@@ -0,0 +1,208 @@
+//Offscreen render benchmark. Every scene is a fixed run of board states played by the bot, which is drawn
+//frame after frame into a framebuffer object, alone as the game draws it or as many boards of a spectated grid. Frame time, draw calls, state changes, the state calls skipped as redundant
+//and bytes uploaded per frame are printed as JSON. Run from the directory the game runs from, the shaders and the bundle are found the same way
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Bot.h"
+#include "Bundle.h"
+#include "Engine.h"
+#include "GpuTimer.hpp"
+#include "Offscreen.h"
+#include "Packer.h"
+#include "Profiler.h"
+#include "Renderer.h"
+
+struct Options {
+	std::uint32_t frames = 600;	//Measured for every scene
+	std::uint32_t warmup = 60;
+	std::uint32_t ticks = 240;	//Board states of a scene, the frames go round them
+	std::uint32_t boards = 0;	//Drawn as a grid of boards when not 0, every board is at another state of the scene
+	const char* trace = nullptr;	//Chrome trace of the measured frames
+};
+
+struct Scene {
+	const char* name;
+	std::uint32_t seed;
+	std::uint64_t skipPieces;	//Placed before the states are taken
+};
+
+static constexpr Scene SCENES[] = {
+	{ "opening", 1, 0 },
+	{ "midgame", 2, 60 },
+	{ "late", 3, 200 }
+};
+
+//One engine tick, drawn as the game draws it halfway to the next tick
+struct State {
+	Engine engine;
+	std::array<Engine::Pos, 4> previous_pos;
+	bool interpolate;
+};
+
+//The bot plays a single-threaded search with no time limit, so a scene is the same on every run
+static std::vector<State> playScene(Scene const& scene, std::uint32_t ticks)
+{
+	ThreadPool pool(1);
+	Bot::Settings settings;
+	settings.depth = 1;
+	settings.budget = std::chrono::hours(1);
+	Bot bot(pool, settings);
+
+	Engine engine(scene.seed);
+	while (engine.getPieces() < scene.skipPieces && !engine.isOver())
+	{
+		auto placed = engine.getPieces();
+		engine.step(bot.think(engine).getMoves());
+		while (engine.getPieces() == placed && !engine.isOver())
+			engine.step();
+	}
+
+	//The moves of a tetramino are given at the tick it appears, so it's seen falling for the rest of them
+	std::vector<State> states;
+	bool planned = false;
+	while (states.size() < ticks && !engine.isOver())
+	{
+		auto previous_pos = engine.getTetramino().tiles_pos;
+		auto events = planned ? engine.step() : engine.step(bot.think(engine).getMoves());
+		planned = !(events & Engine::PLACED);
+		states.push_back({ engine, previous_pos, planned });
+	}
+	return states;
+}
+
+static bool parseOptions(int argc, char* argv[], Options& options)
+{
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		if (arg == "--help" || i + 1 == argc)
+			return false;
+
+		auto value = (std::uint32_t)std::strtoul(argv[++i], nullptr, 10);
+		if (arg == "--trace")
+			options.trace = argv[i];
+		else if (arg == "--frames")
+			options.frames = std::max(value, 1u);
+		else if (arg == "--warmup")
+			options.warmup = value;
+		else if (arg == "--ticks")
+			options.ticks = std::max(value, 1u);
+		else if (arg == "--boards")
+			options.boards = value;
+		else
+			return false;
+	}
+	return true;
+}
+
+int main(int argc, char* argv[])
+{
+	Options options;
+	if (!parseOptions(argc, argv, options))
+	{
+		std::cerr << "Usage: " << argv[0] << " [--frames N] [--warmup N] [--ticks N] [--boards N] [--trace PATH]" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	Offscreen offscreen(Renderer::WIDTH, Renderer::HEIGHT);
+	if (!offscreen.isReady())
+		return EXIT_FAILURE;
+
+	//Without the bundle the textures are left out, the work per frame is the same
+	auto assets = Bundle::map(Packer::BUNDLE_PATH);
+	if (!assets)
+	{
+		std::cerr << "No asset bundle at " << Packer::BUNDLE_PATH << ", drawing without textures" << std::endl;
+		assets = Bundle::fromMemory(Bundle::Writer{}.finish());
+	}
+	Renderer renderer(*assets);
+	GpuTimer gpuTimer("render");
+	Profiler::nameThread("main");
+
+	std::cout << "{\n"
+		<< "  \"renderer\": \"" << offscreen.getRenderer() << "\",\n"
+		<< "  \"width\": " << Renderer::WIDTH << ",\n"
+		<< "  \"height\": " << Renderer::HEIGHT << ",\n"
+		<< "  \"frames\": " << options.frames << ",\n"
+		<< "  \"boards\": " << options.boards << ",\n"
+		<< "  \"scenes\": [";
+
+	bool first = true;
+	for (auto const& scene : SCENES)
+	{
+		auto states = playScene(scene, options.ticks);
+		if (states.empty())
+			continue;
+
+		std::vector<Engine const*> boards(options.boards);
+		auto draw = [&](std::uint32_t frame) {
+			auto const& state = states[frame % states.size()];
+			for (std::size_t k = 0; k < boards.size(); ++k)
+				boards[k] = &states[(frame + k * 7) % states.size()].engine;
+
+			Profiler::Zone zone("frame");
+			gpuTimer.begin();
+			if (boards.empty())
+				renderer.render(state.engine, state.previous_pos, state.interpolate, 0.5f);
+			else
+				renderer.renderGrid(boards);
+			gpuTimer.end();
+			offscreen.finish();
+			};
+		for (std::uint32_t frame = 0; frame < options.warmup; ++frame)
+			draw(frame);
+
+		Profiler::setEnabled(options.trace != nullptr);
+		RenderStats totals;
+		std::vector<double> times(options.frames);
+		for (std::uint32_t frame = 0; frame < options.frames; ++frame)
+		{
+			renderStats.reset();
+			auto start = std::chrono::steady_clock::now();
+			draw(frame);
+			times[frame] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+			totals.drawCalls += renderStats.drawCalls;
+			totals.stateChanges += renderStats.stateChanges;
+			totals.elidedCalls += renderStats.elidedCalls;
+			totals.bytesUploaded += renderStats.bytesUploaded;
+		}
+
+		Profiler::setEnabled(false);
+
+		double sum = 0.;
+		for (auto time : times)
+			sum += time;
+		std::ranges::sort(times);
+		auto percentile = [&](double p) { return times[(std::size_t)(p * (times.size() - 1))]; };
+		double frames = options.frames;
+
+		std::cout << (first ? "\n" : ",\n")
+			<< "    {\"name\": \"" << scene.name << "\""
+			<< ", \"states\": " << states.size()
+			<< ", \"ms_per_frame\": " << sum / frames
+			<< ", \"p50_ms\": " << percentile(0.5)
+			<< ", \"p99_ms\": " << percentile(0.99)
+			<< ", \"max_ms\": " << times.back()
+			<< ", \"draw_calls\": " << totals.drawCalls / frames
+			<< ", \"state_changes\": " << totals.stateChanges / frames
+			<< ", \"elided_calls\": " << totals.elidedCalls / frames
+			<< ", \"bytes_uploaded\": " << totals.bytesUploaded / frames << "}";
+		first = false;
+	}
+	std::cout << "\n  ]\n}" << std::endl;
+
+	if (options.trace && !Profiler::dump(options.trace))
+	{
+		std::cerr << "Failed to save the trace to " << options.trace << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
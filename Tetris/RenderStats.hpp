@@ -0,0 +1,16 @@
+#pragma once
+#include <cstdint>
+
+//GL work done by the renderer, counted at the calls. The render benchmark reads it after every frame
+struct RenderStats {
+	std::uint64_t drawCalls = 0;
+	std::uint64_t stateChanges = 0;		//Programs, vertex arrays, buffers, textures, blending and uniforms set
+	std::uint64_t elidedCalls = 0;		//State calls GlState skipped as they would change nothing
+	std::uint64_t bytesUploaded = 0;	//Buffer data sent from the CPU
+
+	void reset()
+	{
+		*this = {};
+	}
+};
+inline RenderStats renderStats;
@@ -0,0 +1,338 @@
+#include "Renderer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include "Packer.h"
+#include "Profiler.h"
+
+///////////////// Private member methods /////////////////////
+
+void Renderer::init_buffers()
+{
+	constexpr GLfloat vertices[] =
+	{
+		//Triangles				//Textures
+		-0.5f, -0.5f, 0.f,		0.f, 0.f,
+		-0.5f, 0.5f, 0.f,		0.f, 1.f,
+		0.5f, 0.5f, 0.f,		1.f, 1.f,
+
+		-0.5f, -0.5f, 0.f,		0.f, 0.f,
+		0.5f, -0.5f, 0.f,		1.f, 0.f,
+		0.5f, 0.5f, 0.f,		1.f, 1.f
+	};
+
+	glGenBuffers(1, &VBO);
+	glGenVertexArrays(1, &VAO);
+
+	glState.bindVertexArray(VAO);
+
+	glState.bindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(GLfloat), nullptr);
+	glEnableVertexAttribArray(0);
+
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(GLfloat), (void*)(3 * sizeof(GLfloat)));
+	glEnableVertexAttribArray(1);
+
+	this->fieldLayer = std::make_unique<FieldLayer>(VBO, FIELD_ORIGIN, TILE_SIDE);
+	this->tiles = std::make_unique<TileBatch>(VBO);
+}
+
+//Every mipmap level is uploaded straight from the bundle
+void Renderer::init_textures(Bundle const& assets) const
+{
+	//Enable transparency
+	glState.setBlend(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	std::array<GLuint, Packer::TEXTURES.size()> textures;
+	glGenTextures((GLsizei)textures.size(), textures.data());
+	for (GLenum i = 0; i < textures.size(); ++i)
+	{
+		auto const* image = assets.find(Packer::TEXTURES[i].name);
+		if (!image)
+		{
+			std::cerr << "Failed to load texture " << Packer::TEXTURES[i].name << std::endl;
+			continue;
+		}
+
+		//The tiles are layers of an array, so their mipmaps do not bleed into each other
+		GLenum target = image->layers > 1 ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D;
+		glState.bindTexture(i, target, textures[i]);
+		glTexParameteri(target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
+		glTexParameteri(target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
+		glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, (GLint)image->levels - 1);
+
+		for (GLint level = 0; level < (GLint)image->levels; ++level)
+		{
+			auto width = (GLsizei)std::max(image->width >> level, 1u);
+			auto height = (GLsizei)std::max(image->height >> level, 1u);
+			auto const* pixels = assets.getLevel(*image, level);
+			if (target == GL_TEXTURE_2D_ARRAY)
+				glTexImage3D(target, level, GL_RGBA, width, height, image->layers, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+			else
+				glTexImage2D(target, level, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+		}
+	}
+}
+
+void Renderer::init_shader()
+{
+	this->shad = std::make_unique<Shader>("tetris_shad.vert", "tetris_shad.frag");
+	this->tile_shad = std::make_unique<Shader>("tetris_shad.vert", "tetramino_shad.frag");
+
+	//The state shared by the programs lives in one uniform buffer, the tiles are positioned in the unscaled window pixels
+	this->frameBlock = std::make_unique<UniformBuffer<FrameBlock>>(FRAME_BLOCK_BINDING);
+	frameBlock->update({
+		glm::ortho(0.f, WIDTH / SCALE.x, HEIGHT / SCALE.y, 0.f),
+		SCALE,
+		TILE_SIDE,
+		0.f });
+	shad->bindBlock("Frame", FRAME_BLOCK_BINDING);
+	tile_shad->bindBlock("Frame", FRAME_BLOCK_BINDING);
+
+	//The rest of the uniforms are looked up once, only the background texture changes between the draws
+	shadTexture = shad->getUniform<GLint>("texture1");
+	shad->use();
+	shad->setUniform(shad->getUniform<GLint>("instanced"), 0);
+
+	tile_shad->use();
+	tile_shad->setUniform(tile_shad->getUniform<GLint>("instanced"), 1);
+	tile_shad->setUniform(tile_shad->getUniform<GLint>("texture1"), TILES);
+
+	//The grid covers the window like the background, its boards are found by the fragment shader
+	this->grid_shad = std::make_unique<Shader>("tetris_shad.vert", "grid_shad.frag");
+	grid_shad->bindBlock("Frame", FRAME_BLOCK_BINDING);
+	gridOrigin = grid_shad->getUniform<glm::vec2>("gridOrigin");
+	gridCellSize = grid_shad->getUniform<glm::vec2>("cellSize");
+	gridColumns = grid_shad->getUniform<GLint>("columns");
+	gridBoards = grid_shad->getUniform<GLint>("boards");
+	grid_shad->use();
+	grid_shad->setUniform(grid_shad->getUniform<GLint>("instanced"), 0);
+	grid_shad->setUniform(grid_shad->getUniform<GLint>("cells"), CELLS);
+	grid_shad->setUniform(grid_shad->getUniform<GLint>("tiles"), TILES);
+	grid_shad->setUniform(grid_shad->getUniform<glm::vec2>("boardSize"), glm::vec2(BoardGrid::COLUMNS, BoardGrid::ROWS));
+}
+
+//Drawings
+//Tiles are only queued here, all of them are drawn at once by drawTiles
+void Renderer::pushTile(Tile const& tile, glm::vec2 const& position) const
+{
+	tiles->push(position, tile.color, tile.transparency);
+}
+
+//Whole pixels of the target which the rect touches, its y axis goes up
+void Renderer::scissor(Rect const& rect) const
+{
+	auto sx = (GLfloat)width / (WIDTH / SCALE.x);
+	auto sy = (GLfloat)height / (HEIGHT / SCALE.y);
+	auto left = (GLint)std::floor(rect.origin.x * sx);
+	auto right = (GLint)std::ceil((rect.origin.x + rect.size.x) * sx);
+	auto bottom = height - (GLint)std::ceil((rect.origin.y + rect.size.y) * sy);
+	auto top = height - (GLint)std::floor(rect.origin.y * sy);
+	glState.setScissor(left, bottom, right - left, top - bottom);
+}
+
+void Renderer::drawBackground() const
+{
+	Profiler::Zone zone("drawBackground");
+
+	shad->use();
+	glState.bindVertexArray(VAO);
+
+	shad->setUniform(shadTexture, BACKGROUND);
+	++renderStats.drawCalls;
+	glDrawArrays(GL_TRIANGLES, 0, 6);
+}
+
+void Renderer::drawFrame() const
+{
+	Profiler::Zone zone("drawFrame");
+
+	shad->use();
+	glState.bindVertexArray(VAO);
+
+	shad->setUniform(shadTexture, FRAME);
+	++renderStats.drawCalls;
+	glDrawArrays(GL_TRIANGLES, 0, 6);
+}
+
+//The frame is drawn over the field tiles, so under the field the cache keeps the background only
+void Renderer::drawStatic() const
+{
+	Profiler::Zone zone("drawStatic");
+
+	layers->begin();
+	this->drawBackground();
+	this->drawFrame();
+
+	//The background is opaque and covers the frame
+	this->scissor(FIELD_RECT);
+	this->drawBackground();
+	glState.disableScissor();
+	layers->end(target);
+}
+
+void Renderer::drawField(Engine const& engine, std::array<Engine::Pos, 4> const& previous_pos, bool interpolate, float alpha) const
+{
+	Profiler::Zone zone("drawField");
+
+	auto fieldPos = [](Engine::Pos const& pos) {
+		return FIELD_ORIGIN + glm::vec2{ (GLfloat)pos.j, (GLfloat)pos.i } * TILE_SIDE;
+		};
+
+	//The locked tiles are a layer of their own, only the rows changed since the last frame are uploaded
+	fieldLayer->update(engine.getField());
+
+	//The tetramino and its shadow are an overlay over the field, tiles above the field are not visible
+	auto const& tetramino = engine.getTetramino();
+	for (auto const& shadow_tile : tetramino.shadow)
+		if (shadow_tile.i >= 0 && std::ranges::find(tetramino.tiles_pos, shadow_tile) == tetramino.tiles_pos.end())
+			this->pushTile({ tetramino.color, 0.5f }, fieldPos(shadow_tile));
+
+	//Only a plain shift is interpolated, rotated tiles jump to their places
+	auto const& tiles_pos = tetramino.tiles_pos;
+	auto shift = [&](size_t k) {
+		return Engine::Pos{ tiles_pos[k].i - previous_pos[k].i, tiles_pos[k].j - previous_pos[k].j };
+		};
+	bool shifted = interpolate;
+	for (size_t k = 1; k < tiles_pos.size(); ++k)
+		shifted = shifted && shift(k) == shift(0);
+
+	for (size_t k = 0; k < tiles_pos.size(); ++k)
+		if (auto const& tetr_tile = tiles_pos[k]; tetr_tile.i >= 0)
+		{
+			auto pos = fieldPos(tetr_tile);
+			if (shifted)
+				pos = glm::mix(fieldPos(previous_pos[k]), pos, alpha);
+			this->pushTile({ tetramino.color, 0.f }, pos);
+		}
+}
+
+void Renderer::drawNextTetraminos(Engine const& engine) const
+{
+	Profiler::Zone zone("drawNextTetraminos");
+
+	//Tetraminos are shown turned once, so the I fits into the two columns of the preview
+	std::ranges::for_each(engine.getNextTetraminos(), [this, i = 0](Engine::TetraminoPrototype const& tetr) mutable {
+		auto const& state = Engine::Rotations::STATES[(std::size_t)tetr.shape][PREVIEW_ROTATION];
+		std::ranges::for_each(state.cells, [&](Engine::Pos const& cell) {
+			this->pushTile({ tetr.color, 0.f }, {
+				PREVIEW_ORIGIN.x + TILE_SIDE * (cell.j - state.left),
+				PREVIEW_ORIGIN.y + PREVIEW_STEP * i + TILE_SIDE * (cell.i - state.top) });
+			}
+		);
+		++i;
+		}
+	);
+}
+
+void Renderer::drawTiles() const
+{
+	Profiler::Zone zone("drawTiles");
+
+	tile_shad->use();
+	fieldLayer->draw();
+	tiles->draw();
+	tiles->clear();
+}
+
+//The boards are as large as the best number of columns lets them be, a cell is whole pixels once it's larger than one
+void Renderer::drawGrid(std::span<Engine const* const> boards) const
+{
+	Profiler::Zone zone("drawGrid");
+
+	grid->update(boards);
+	auto count = (GLint)boards.size();
+	if (!count)
+		return;
+
+	constexpr GLfloat SLOT_WIDTH = BoardGrid::COLUMNS + GRID_GAP;
+	constexpr GLfloat SLOT_HEIGHT = BoardGrid::ROWS + GRID_GAP;
+	GLint columns = 1;
+	GLfloat side = 0.f;
+	for (GLint c = 1; c <= count; ++c)
+	{
+		auto rows = (count + c - 1) / c;
+		auto fit = std::min(width / (c * SLOT_WIDTH - GRID_GAP), height / (rows * SLOT_HEIGHT - GRID_GAP));
+		if (fit >= 1.f)
+			fit = std::floor(fit);
+		if (fit > side)
+		{
+			side = fit;
+			columns = c;
+		}
+	}
+	auto rows = (count + columns - 1) / columns;
+	auto left = std::floor((width - (columns * SLOT_WIDTH - GRID_GAP) * side) / 2.f);
+	auto top = std::floor((height - (rows * SLOT_HEIGHT - GRID_GAP) * side) / 2.f);
+
+	grid_shad->use();
+	glState.bindVertexArray(VAO);
+	grid_shad->setUniform(gridOrigin, glm::vec2(left / width, 1.f - top / height));
+	grid_shad->setUniform(gridCellSize, glm::vec2(side / width, side / height));
+	grid_shad->setUniform(gridColumns, columns);
+	grid_shad->setUniform(gridBoards, count);
+	++renderStats.drawCalls;
+	glDrawArrays(GL_TRIANGLES, 0, 6);
+}
+
+///////////////// Public member methods /////////////////////
+
+Renderer::Renderer(Bundle const& assets)
+{
+	GLint bound;
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &bound);
+	this->target = (GLuint)bound;
+
+	this->init_buffers();
+	this->init_textures(assets);
+	this->init_shader();
+	this->grid = std::make_unique<BoardGrid>(CELLS);
+	this->layers = std::make_unique<LayerCache>();
+	this->resize(WIDTH, HEIGHT);
+}
+
+Renderer::~Renderer()
+{
+	glState.deleteBuffer(VBO);
+	glState.deleteVertexArray(VAO);
+}
+
+void Renderer::resize(GLsizei width, GLsizei height)
+{
+	this->width = width;
+	this->height = height;
+	glViewport(0, 0, width, height);
+	layers->resize(width, height);
+}
+
+void Renderer::invalidate()
+{
+	layers->invalidate();
+}
+
+//The tiles are drawn under the frame in one call, the frame only has faint pixels over the next tetraminos.
+//The background and the frame are copied from the cache, the frame is only drawn again over the tiles
+void Renderer::render(Engine const& engine, std::array<Engine::Pos, 4> const& previous_pos, bool interpolate, float alpha) const
+{
+	if (!layers->isValid())
+		this->drawStatic();
+	layers->blit(target);
+
+	this->drawField(engine, previous_pos, interpolate, alpha);
+	this->drawNextTetraminos(engine);
+	this->drawTiles();
+
+	this->scissor(FIELD_RECT);
+	this->drawFrame();
+	glState.disableScissor();
+}
+
+void Renderer::renderGrid(std::span<Engine const* const> boards) const
+{
+	this->drawBackground();
+	this->drawGrid(boards);
+}
@@ -0,0 +1,121 @@
+#pragma once
+#include <glad/glad.h>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <array>
+#include <memory>
+#include <span>
+
+#include "BoardGrid.hpp"
+#include "Bundle.h"
+#include "Engine.h"
+#include "FieldLayer.hpp"
+#include "LayerCache.hpp"
+#include "RenderStats.hpp"
+#include "Shader.hpp"
+#include "TileBatch.hpp"
+
+//Draws the game into the bound framebuffer, which is the window's or an offscreen one.
+//Needs a current OpenGL 3.3 context, the shaders are read from the working directory
+class Renderer
+{
+public:
+	static constexpr glm::vec2 SCALE = glm::vec2(2.f);
+	static constexpr GLsizei WIDTH = (GLsizei)(320 * SCALE.x);
+	static constexpr GLsizei HEIGHT = (GLsizei)(480 * SCALE.y);
+	static constexpr GLfloat TILE_SIDE = 18;
+	static constexpr glm::vec2 FIELD_ORIGIN = glm::vec2(28.f, 31.f);	//Top-left corner of the field in the unscaled window pixels
+	static constexpr glm::vec2 PREVIEW_ORIGIN = glm::vec2(250.f, 90.f);	//Top-left corner of the first next tetramino
+	static constexpr GLfloat PREVIEW_STEP = 90.f;	//Between the next tetraminos
+	static constexpr std::size_t PREVIEW_ROTATION = 1;
+
+private:
+	//Enumerations
+	enum Textures
+	{
+		TILES,
+		FRAME,
+		BACKGROUND,
+		CELLS	//Not from the bundle, the boards of the grid
+	};
+
+	//Uniform block shared by the programs, std140 layout
+	struct FrameBlock {
+		glm::mat4 projection;
+		glm::vec2 scale;
+		GLfloat tileSize;
+		GLfloat padding;
+	};
+	static constexpr GLuint FRAME_BLOCK_BINDING = 0;
+
+	//Box in the unscaled window pixels
+	struct Rect {
+		glm::vec2 origin;
+		glm::vec2 size;
+	};
+
+	//The field tiles are drawn under the frame, so this part of it is drawn again over them.
+	//The next tetraminos are drawn over the frame and need nothing of it
+	static constexpr Rect FIELD_RECT = { FIELD_ORIGIN, glm::vec2(Engine::GRID_NUMBER_J * TILE_SIDE, Engine::GRID_NUMBER_I * TILE_SIDE) };
+
+	static constexpr GLfloat GRID_GAP = 1.f;	//Cells between the boards of the grid, as in grid_shad.frag
+
+	//Describes tile settings at field
+	struct Tile{
+		TileColor color;
+		GLfloat transparency;
+	};
+
+	GLuint VAO;
+	GLuint VBO;
+	std::unique_ptr<Shader> shad;
+	std::unique_ptr<Shader> tile_shad;
+	std::unique_ptr<Shader> grid_shad;
+	std::unique_ptr<UniformBuffer<FrameBlock>> frameBlock;
+	std::unique_ptr<FieldLayer> fieldLayer;
+	std::unique_ptr<TileBatch> tiles;
+	std::unique_ptr<BoardGrid> grid;
+	Uniform<GLint> shadTexture;
+	Uniform<glm::vec2> gridOrigin;
+	Uniform<glm::vec2> gridCellSize;
+	Uniform<GLint> gridColumns;
+	Uniform<GLint> gridBoards;
+	GLuint target;	//Framebuffer bound at the construction, the frames are drawn into it
+	GLsizei width = WIDTH;
+	GLsizei height = HEIGHT;
+	std::unique_ptr<LayerCache> layers;	//The background and the frame
+
+	//Initialization member functions
+	void init_buffers();
+	void init_textures(Bundle const&) const;
+	void init_shader();
+
+	//Drawable member functions
+	void pushTile(Tile const&, glm::vec2 const& pos) const;
+	void scissor(Rect const&) const;
+	void drawBackground() const;
+	void drawFrame() const;
+	void drawStatic() const;
+	void drawField(Engine const&, std::array<Engine::Pos, 4> const& previous_pos, bool interpolate, float alpha) const;
+	void drawNextTetraminos(Engine const&) const;
+	void drawTiles() const;
+	void drawGrid(std::span<Engine const* const>) const;
+
+public:
+	//The textures are uploaded from the bundle, it's not needed afterwards
+	explicit Renderer(Bundle const&);
+	~Renderer();
+
+	Renderer(Renderer const&) = delete;
+	Renderer& operator=(Renderer const&) = delete;
+
+	//Size of the target framebuffer in pixels, the picture is stretched over it
+	void resize(GLsizei width, GLsizei height);
+	//The background and the frame are drawn again in the next frame, e.g. after their textures changed
+	void invalidate();
+
+	//The tetramino is drawn 'alpha' of the way from its previous position if it was only shifted since then
+	void render(Engine const&, std::array<Engine::Pos, 4> const& previous_pos, bool interpolate, float alpha) const;
+	//Any number of boards over the background, they are drawn with the same two calls however many there are
+	void renderGrid(std::span<Engine const* const>) const;
+};
@@ -0,0 +1,198 @@
+#include "Replay.h"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <iterator>
+
+static constexpr std::array<std::uint8_t, 4> MAGIC{ 'T', 'R', 'P', 'L' };
+
+static void writeU32(std::vector<std::uint8_t>& data, std::uint32_t value)
+{
+	for (int i = 0; i < 4; ++i)
+		data.push_back((std::uint8_t)(value >> (8 * i)));
+}
+
+static std::uint32_t readU32(std::uint8_t const* bytes)
+{
+	return bytes[0] | bytes[1] << 8 | bytes[2] << 16 | (std::uint32_t)bytes[3] << 24;
+}
+
+static bool readVarint(std::vector<std::uint8_t> const& data, std::size_t& offset, std::uint64_t& value)
+{
+	value = 0;
+	for (int shift = 0; shift < 64; shift += 7)
+	{
+		if (offset >= data.size())
+			return false;
+
+		auto byte = data[offset++];
+		value |= (std::uint64_t)(byte & 0x7F) << shift;
+		if (!(byte & 0x80))
+			return true;
+	}
+	return false;
+}
+
+Replay::Replay(std::uint32_t sd, std::uint32_t rate)
+	: seed(sd), tickRate(rate)
+{
+	data.assign(MAGIC.begin(), MAGIC.end());
+	data.push_back(VERSION);
+	writeU32(data, seed);
+	writeU32(data, tickRate);
+}
+
+void Replay::writeVarint(std::uint64_t value)
+{
+	do
+	{
+		std::uint8_t byte = value & 0x7F;
+		value >>= 7;
+		data.push_back(value ? byte | 0x80 : byte);
+	} while (value);
+}
+
+void Replay::record(std::uint64_t tick, std::span<Engine::MovingType const> moves)
+{
+	if (finished)
+		return;
+
+	for (auto move : moves)
+	{
+		writeVarint(tick - lastTick);
+		data.push_back((std::uint8_t)move);
+		lastTick = tick;
+	}
+}
+
+void Replay::finish(std::uint64_t tick)
+{
+	if (finished)
+		return;
+
+	writeVarint(tick - lastTick);
+	data.push_back(END_MARK);
+	lastTick = length = tick;
+	finished = true;
+}
+
+bool Replay::save(const char* path) const
+{
+	std::ofstream ofs(path, std::ios::binary);
+	ofs.write((const char*)data.data(), data.size());
+	return (bool)ofs;
+}
+
+std::optional<Replay> Replay::load(const char* path)
+{
+	std::ifstream ifs(path, std::ios::binary);
+	if (!ifs)
+		return std::nullopt;
+
+	return parse({ std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>() });
+}
+
+std::optional<Replay> Replay::parse(std::vector<std::uint8_t> bytes)
+{
+	if (bytes.size() < HEADER_SIZE || !std::equal(MAGIC.begin(), MAGIC.end(), bytes.begin()) || bytes[4] != VERSION)
+		return std::nullopt;
+
+	Replay replay(readU32(&bytes[5]), readU32(&bytes[9]));
+	replay.data = std::move(bytes);
+
+	//Walk the records to find the length, a truncated replay ends at its last complete record
+	auto const& data = replay.data;
+	std::size_t offset = HEADER_SIZE;
+	std::uint64_t tick = 0;
+	std::uint64_t delta;
+	while (readVarint(data, offset, delta) && offset < data.size())
+	{
+		auto move = data[offset++];
+		if (move == END_MARK)
+		{
+			replay.finished = true;
+			tick += delta;
+			break;
+		}
+		if (move > (std::uint8_t)Engine::MovingType::FALL)
+			break;
+		tick += delta;
+	}
+
+	replay.lastTick = replay.length = tick;
+	return replay;
+}
+
+bool Replay::read(std::size_t& offset, std::uint64_t& tick, Record& record) const
+{
+	std::uint64_t delta;
+	if (!readVarint(data, offset, delta) || offset >= data.size())
+		return false;
+
+	auto move = data[offset++];
+	if (move > (std::uint8_t)Engine::MovingType::FALL)
+		return false;
+
+	tick += delta;
+	record = { tick, (Engine::MovingType)move };
+	return true;
+}
+
+ReplayPlayer::ReplayPlayer(Replay const& rp)
+	: replay(rp), engine(rp.createEngine())
+{
+	hasNext = replay.read(offset, recordTick, next);
+}
+
+void ReplayPlayer::restore(Keyframe const& keyframe)
+{
+	engine.restore(keyframe.snapshot);
+	offset = keyframe.offset;
+	recordTick = keyframe.recordTick;
+	next = keyframe.next;
+	hasNext = keyframe.hasNext;
+}
+
+Engine::Events ReplayPlayer::step()
+{
+	if (isFinished())
+		return Engine::NO_EVENT;
+
+	auto tick = engine.getTick();
+	if (tick % KEYFRAME_TICKS == 0 && keyframes.size() == tick / KEYFRAME_TICKS)
+	{
+		auto& keyframe = keyframes.emplace_back(Keyframe{ {}, offset, recordTick, next, hasNext });
+		engine.save(keyframe.snapshot);
+	}
+
+	//Every record of this tick goes into the same step, as it was recorded, however many there are
+	moves.clear();
+	while (hasNext && next.tick <= tick)
+	{
+		moves.push_back(next.move);
+		hasNext = replay.read(offset, recordTick, next);
+	}
+
+	return engine.step(moves);
+}
+
+void ReplayPlayer::runTo(std::uint64_t tick)
+{
+	while (engine.getTick() < tick && !isFinished())
+		this->step();
+}
+
+void ReplayPlayer::seek(std::uint64_t tick)
+{
+	//Go back to the closest keyframe before the tick unless the current state is closer.
+	//The first keyframe is taken at tick 0, so there is always one to go back to
+	if (!keyframes.empty())
+	{
+		auto const& keyframe = keyframes[std::min<std::uint64_t>(tick / KEYFRAME_TICKS, keyframes.size() - 1)];
+		if (tick < engine.getTick() || keyframe.snapshot.tick > engine.getTick())
+			this->restore(keyframe);
+	}
+
+	this->runTo(tick);
+}
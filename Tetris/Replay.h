@@ -0,0 +1,96 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "Engine.h"
+
+//Seed and tick-stamped inputs of one game, enough to simulate it again bit-exactly.
+//Binary layout, all numbers are little-endian:
+//	header	"TRPL", version (1 byte), seed (4 bytes), tick rate (4 bytes)
+//	records	tick delta since the previous record (LEB128), move (1 byte)
+//	end		tick delta to the last tick (LEB128), END_MARK
+class Replay
+{
+public:
+	static constexpr std::uint8_t VERSION = 4;	//Changes with the rules, an older replay would play differently
+	static constexpr std::uint8_t END_MARK = 0xFF;
+	static constexpr std::size_t HEADER_SIZE = 13;
+
+	struct Record {
+		std::uint64_t tick;
+		Engine::MovingType move;
+	};
+
+private:
+	std::vector<std::uint8_t> data;
+	std::uint32_t seed;
+	std::uint32_t tickRate;
+	std::uint64_t lastTick = 0;
+	std::uint64_t length = 0;
+	bool finished = false;
+
+	void writeVarint(std::uint64_t value);
+
+public:
+	Replay(std::uint32_t seed, std::uint32_t tickRate);
+
+	//Recording, ticks have to be non-decreasing
+	void record(std::uint64_t tick, std::span<Engine::MovingType const> moves);
+	void finish(std::uint64_t tick);
+
+	bool save(const char* path) const;
+	static std::optional<Replay> load(const char* path);
+	static std::optional<Replay> parse(std::vector<std::uint8_t> bytes);
+
+	//Decodes the record at the offset and moves the offset past it, returns false at the end mark
+	bool read(std::size_t& offset, std::uint64_t& tick, Record& record) const;
+
+	Engine createEngine() const { return Engine(seed, tickRate); }
+	std::vector<std::uint8_t> const& getData() const { return data; }
+	std::uint32_t getSeed() const { return seed; }
+	std::uint32_t getTickRate() const { return tickRate; }
+	std::uint64_t getLength() const { return length; }	//Number of ticks in a finished replay
+};
+
+//Simulates a replay tick by tick, either paced by the caller or as fast as possible.
+//Snapshots of the engine are kept every KEYFRAME_TICKS ticks so seeking back does not start from the beginning.
+//The replay has to be finished and outlive the player
+class ReplayPlayer
+{
+public:
+	static constexpr std::uint64_t KEYFRAME_TICKS = 1024;
+
+private:
+	struct Keyframe {
+		Engine::Snapshot snapshot;
+		std::size_t offset;
+		std::uint64_t recordTick;
+		Replay::Record next;
+		bool hasNext;
+	};
+
+	Replay const& replay;
+	Engine engine;
+	std::size_t offset = Replay::HEADER_SIZE;
+	std::uint64_t recordTick = 0;	//Tick of the last decoded record, records store the deltas
+	Replay::Record next{};
+	bool hasNext = false;
+	std::vector<Keyframe> keyframes;
+	std::vector<Engine::MovingType> moves;	//Inputs of the current tick, kept to not allocate every tick
+
+	void restore(Keyframe const&);
+
+public:
+	explicit ReplayPlayer(Replay const&);
+
+	//Runs one tick with the recorded inputs
+	Engine::Events step();
+	//Simulates without any pacing until the tick or the end of the replay
+	void runTo(std::uint64_t tick);
+	void seek(std::uint64_t tick);
+
+	Engine const& getEngine() const { return engine; }
+	bool isFinished() const { return engine.isOver() || engine.getTick() >= replay.getLength(); }
+};
@@ -0,0 +1,52 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+#include "Engine.h"
+
+//The last N snapshots of a game, a new one takes the place of the oldest.
+//The storage is fixed, nothing is allocated after construction
+template<class E, std::size_t N>
+class Rewind
+{
+	static_assert(N && (N & (N - 1)) == 0, "Capacity has to be a power of two");
+
+	std::array<typename E::Snapshot, N> snapshots;
+	std::size_t next = 0;	//Slot of the next snapshot
+	std::size_t count = 0;
+
+public:
+	void push(E const& engine)
+	{
+		engine.save(snapshots[next++ & (N - 1)]);
+		count = std::min(count + 1, N);
+	}
+
+	//The snapshot pushed 'back' snapshots before the newest one, nullptr if it is not kept any more
+	typename E::Snapshot const* peek(std::size_t back = 0) const
+	{
+		return back < count ? &snapshots[(next - 1 - back) & (N - 1)] : nullptr;
+	}
+
+	//Restores the snapshot 'back' snapshots before the newest one, the newer ones are dropped and it becomes the newest
+	bool rewind(E& engine, std::size_t back = 0)
+	{
+		auto const* snapshot = peek(back);
+		if (!snapshot)
+			return false;
+
+		engine.restore(*snapshot);
+		next -= back;
+		count -= back;
+		return true;
+	}
+
+	void clear()
+	{
+		count = 0;
+	}
+
+	std::size_t size() const { return count; }
+	static constexpr std::size_t capacity() { return N; }
+};
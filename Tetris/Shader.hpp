@@ -2,40 +2,153 @@
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
 
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
 #include <fstream>
+#include <iostream>
+#include <iterator>
 #include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "GlState.hpp"
+#include "RenderStats.hpp"
+
+//Typed handle of a uniform, the location is looked up once
+template<class T>
+struct Uniform
+{
+	GLint location = -1;
+};
 
 class Shader
 {
-public:
-	GLuint ID;
+	//Locations of the active uniforms, filled once after linking
+	std::unordered_map<std::string, GLint> uniforms;
 
-	Shader(const char* vertShdPath, const char* fragShdPath)
+	void reflect()
 	{
-		/*Read files*/
-		std::ifstream ifsVert(vertShdPath);
-		std::ifstream ifsFrag(fragShdPath);
+		GLint count;
+		GLint maxLength;
+		glGetProgramiv(this->ID, GL_ACTIVE_UNIFORMS, &count);
+		glGetProgramiv(this->ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
 
-		if (!ifsVert)
-		{
-			std::cerr << "The vertex shader path is incorrect: " << vertShdPath << '\n';
-			glfwTerminate();
-		}
-		if (!ifsFrag)
+		std::string name(maxLength, '\0');
+		for (GLint i = 0; i < count; ++i)
 		{
-			std::cerr << "The fragment shader path is incorrect: " << fragShdPath << '\n';
-			glfwTerminate();
+			GLsizei length;
+			GLint size;
+			GLenum type;
+			glGetActiveUniform(this->ID, i, maxLength, &length, &size, &type, name.data());
+
+			//Uniforms from the blocks have no location
+			GLint location = glGetUniformLocation(this->ID, name.c_str());
+			if (location == -1)
+				continue;
+
+			//Arrays are reported as "name[0]", keep them accessible by the plain name
+			std::string key(name.data(), length);
+			if (key.ends_with("[0]"))
+				key.resize(key.size() - 3);
+			uniforms.emplace(std::move(key), location);
 		}
+	}
+
+	//Compiled programs are kept by the driver's binary format, keyed by the sources and the driver
+	static constexpr const char* CACHE_DIRECTORY = "shader_cache";
+	static constexpr std::uint32_t CACHE_MAGIC = 0x47525054;	//"TPRG"
+
+	//Header of a cache file, the program binary follows it
+	struct CacheHeader {
+		std::uint32_t magic;
+		GLenum format;
+		std::uint64_t key;
+	};
+
+	static std::string readFile(const char* path, const char* kind)
+	{
+		std::ifstream ifs(path);
+		//The empty source fails to compile and is reported again there
+		if (!ifs)
+			std::cerr << "The " << kind << " shader path is incorrect: " << path << '\n';
+
+		std::stringstream ss;
+		ss << ifs.rdbuf();
+		return ss.str();
+	}
+
+	//FNV-1a of the sources and of the driver, a new driver makes the old binaries useless
+	static std::uint64_t cacheKey(std::string const& vertSrc, std::string const& fragSrc)
+	{
+		std::uint64_t hash = 0xcbf29ce484222325;
+		auto add = [&hash](const char* data) {
+			for (; data && *data; ++data)
+				hash = (hash ^ (std::uint8_t)*data) * 0x100000001b3;
+			hash = (hash ^ 0xFF) * 0x100000001b3;
+			};
+
+		add(vertSrc.c_str());
+		add(fragSrc.c_str());
+		for (GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION })
+			add((const char*)glGetString(name));
+		return hash;
+	}
 
-		std::stringstream ssVert;
-		std::stringstream ssFrag;
-		ssVert << ifsVert.rdbuf();
-		ssFrag << ifsFrag.rdbuf();
+	static bool isCacheSupported()
+	{
+		GLint formats = 0;
+		if (glGetProgramBinary && glProgramBinary)
+			glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+		return formats > 0;
+	}
+
+	static std::filesystem::path cachePath(std::uint64_t key)
+	{
+		char name[24];
+		std::snprintf(name, sizeof(name), "%016llx.bin", (unsigned long long)key);
+		return std::filesystem::path(CACHE_DIRECTORY) / name;
+	}
+
+	//Returns false if there is no binary or the driver does not take it any more
+	bool loadBinary(std::uint64_t key)
+	{
+		std::ifstream ifs(cachePath(key), std::ios::binary);
+		CacheHeader header;
+		if (!ifs.read((char*)&header, sizeof(header)) || header.magic != CACHE_MAGIC || header.key != key)
+			return false;
+
+		std::vector<char> binary{ std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>() };
+		glProgramBinary(this->ID, header.format, binary.data(), (GLsizei)binary.size());
+
+		GLint success;
+		glGetProgramiv(this->ID, GL_LINK_STATUS, &success);
+		return success;
+	}
 
-		std::string vertShdSrc = ssVert.str();
-		std::string fragShdSrc = ssFrag.str();
+	void saveBinary(std::uint64_t key) const
+	{
+		GLint length = 0;
+		glGetProgramiv(this->ID, GL_PROGRAM_BINARY_LENGTH, &length);
+		if (!length)
+			return;
+
+		CacheHeader header{ CACHE_MAGIC, 0, key };
+		std::vector<char> binary(length);
+		glGetProgramBinary(this->ID, length, nullptr, &header.format, binary.data());
+
+		std::error_code error;
+		std::filesystem::create_directories(CACHE_DIRECTORY, error);
+		std::ofstream ofs(cachePath(key), std::ios::binary);
+		ofs.write((const char*)&header, sizeof(header));
+		ofs.write(binary.data(), binary.size());
+	}
 
-		/*Now create shader program*/
+	void compile(std::string const& vertShdSrc, std::string const& fragShdSrc, bool retrievable)
+	{
 		GLuint vertShad = glCreateShader(GL_VERTEX_SHADER);
 		GLuint fragShad = glCreateShader(GL_FRAGMENT_SHADER);
 
@@ -64,9 +177,10 @@ public:
 			std::cerr << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
 		}
 
-		this->ID = glCreateProgram();
 		glAttachShader(this->ID, vertShad);
 		glAttachShader(this->ID, fragShad);
+		if (retrievable)
+			glProgramParameteri(this->ID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
 		glLinkProgram(this->ID);
 
 		glGetProgramiv(this->ID, GL_LINK_STATUS, &success);
@@ -75,62 +189,179 @@ public:
 			std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
 		}
 
+		glDetachShader(this->ID, vertShad);
+		glDetachShader(this->ID, fragShad);
 		glDeleteShader(vertShad);
 		glDeleteShader(fragShad);
 	}
 
+public:
+	GLuint ID;
+	bool fromCache = false;
+	double buildTime = 0.;	//Milliseconds to get the program linked, from the cache or from the sources
+
+	//The program is taken from the binary cache when the driver has it, otherwise it's compiled and cached
+	Shader(const char* vertShdPath, const char* fragShdPath)
+	{
+		std::string vertShdSrc = readFile(vertShdPath, "vertex");
+		std::string fragShdSrc = readFile(fragShdPath, "fragment");
+
+		auto start = std::chrono::steady_clock::now();
+		this->ID = glCreateProgram();
+
+		bool cached = isCacheSupported();
+		auto key = cached ? cacheKey(vertShdSrc, fragShdSrc) : 0;
+		fromCache = cached && this->loadBinary(key);
+		if (!fromCache)
+		{
+			this->compile(vertShdSrc, fragShdSrc, cached);
+			if (cached)
+				this->saveBinary(key);
+		}
+
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+		buildTime = elapsed.count();
+		std::clog << vertShdPath << " + " << fragShdPath << (fromCache ? " loaded from the cache in " : " compiled in ")
+			<< buildTime << " ms" << std::endl;
+
+		this->reflect();
+	}
+
 	void use() const
 	{
-		glUseProgram(this->ID);
+		glState.useProgram(this->ID);
 	}
 
 	GLint getUniformLocation(const char* name) const
 	{
-		return glGetUniformLocation(this->ID, name);
+		auto it = uniforms.find(name);
+		return it != uniforms.end() ? it->second : -1;
+	}
+
+	template<class T>
+	Uniform<T> getUniform(const char* name) const
+	{
+		return { this->getUniformLocation(name) };
+	}
+
+	//Connects the named uniform block to the buffer bound at the binding point
+	void bindBlock(const char* name, GLuint binding) const
+	{
+		GLuint index = glGetUniformBlockIndex(this->ID, name);
+		if (index != GL_INVALID_INDEX)
+			glUniformBlockBinding(this->ID, index, binding);
+	}
+
+	//Scalars and vectors are only set when they differ from the values the program has
+	void setUniform(Uniform<GLfloat> uniform, GLfloat value) const
+	{
+		if (glState.setsUniform(uniform.location, value))
+			glUniform1f(uniform.location, value);
+	}
+
+	void setUniform(Uniform<GLuint> uniform, GLuint value) const
+	{
+		if (glState.setsUniform(uniform.location, value))
+			glUniform1ui(uniform.location, value);
+	}
+
+	void setUniform(Uniform<GLint> uniform, GLint value) const
+	{
+		if (glState.setsUniform(uniform.location, value))
+			glUniform1i(uniform.location, value);
+	}
+
+	void setUniform(Uniform<glm::vec2> uniform, glm::vec2 const& value) const
+	{
+		if (glState.setsUniform(uniform.location, value))
+			glUniform2f(uniform.location, value.x, value.y);
+	}
+
+	void setUniform(Uniform<glm::mat4> uniform, glm::mat4 const& matrix) const
+	{
+		++renderStats.stateChanges;
+		glUniformMatrix4fv(uniform.location, 1, GL_FALSE, glm::value_ptr(matrix));
 	}
 
 	void setUniform(const char* name, GLfloat value) const
 	{
-		glUniform1f(this->getUniformLocation(name), value);
+		this->setUniform(this->getUniform<GLfloat>(name), value);
 	}
 
 	void setUniform(const char* name, GLfloat v1, GLfloat v2) const
 	{
-		glUniform2f(this->getUniformLocation(name), v1, v2);
+		this->setUniform(this->getUniform<glm::vec2>(name), glm::vec2(v1, v2));
 	}
 
 	void setUniform(const char* name, GLfloat v1, GLfloat v2, GLfloat v3) const
 	{
-		glUniform3f(this->getUniformLocation(name), v1, v2, v3);
+		GLint location = this->getUniformLocation(name);
+		if (glState.setsUniform(location, std::array{ v1, v2, v3 }))
+			glUniform3f(location, v1, v2, v3);
 	}
 
 	void setUniform(const char* name, GLfloat v1, GLfloat v2, GLfloat v3, GLfloat v4) const
 	{
-		glUniform4f(this->getUniformLocation(name), v1, v2, v3, v4);
+		GLint location = this->getUniformLocation(name);
+		if (glState.setsUniform(location, std::array{ v1, v2, v3, v4 }))
+			glUniform4f(location, v1, v2, v3, v4);
 	}
 
 	void setUniform(const char* name, GLuint value) const
 	{
-		glUniform1ui(this->getUniformLocation(name), value);
+		this->setUniform(this->getUniform<GLuint>(name), value);
 	}
 
 	void setUniform(const char* name, GLint value) const
 	{
-		glUniform1i(this->getUniformLocation(name), value);
+		this->setUniform(this->getUniform<GLint>(name), value);
 	}
 
 	void setUniform(const char* name, glm::mat4 const& matrix) const
 	{
-		glUniformMatrix4fv(this->getUniformLocation(name), 1, GL_FALSE, glm::value_ptr(matrix));
+		this->setUniform(this->getUniform<glm::mat4>(name), matrix);
 	}
 
 	void setUniform(const char* name, glm::f32*	val) const
 	{
+		++renderStats.stateChanges;
 		glUniformMatrix4fv(this->getUniformLocation(name), 1, GL_FALSE, val);
 	}
 	void setUniform(const char* name, const glm::f32* val) const
 	{
+		++renderStats.stateChanges;
 		glUniformMatrix4fv(this->getUniformLocation(name), 1, GL_FALSE, val);
 	}
 };
 
+//Uniform block storage shared by all the programs which bind the block to the same point.
+//The block type has to follow the std140 layout
+template<class Block>
+class UniformBuffer
+{
+	GLuint ID;
+
+public:
+	explicit UniformBuffer(GLuint binding)
+	{
+		glGenBuffers(1, &this->ID);
+		glState.bindBuffer(GL_UNIFORM_BUFFER, this->ID);
+		glBufferData(GL_UNIFORM_BUFFER, sizeof(Block), nullptr, GL_DYNAMIC_DRAW);
+		glState.bindBufferBase(GL_UNIFORM_BUFFER, binding, this->ID);
+	}
+
+	~UniformBuffer()
+	{
+		glState.deleteBuffer(this->ID);
+	}
+
+	UniformBuffer(UniformBuffer const&) = delete;
+	UniformBuffer& operator=(UniformBuffer const&) = delete;
+
+	void update(Block const& block) const
+	{
+		renderStats.bytesUploaded += sizeof(Block);
+		glState.bindBuffer(GL_UNIFORM_BUFFER, this->ID);
+		glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(Block), &block);
+	}
+};
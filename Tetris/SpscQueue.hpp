@@ -0,0 +1,58 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+//Lock-free ring buffer for exactly one producer thread and one consumer thread.
+//The storage is fixed, nothing is allocated after construction
+template<class T, std::size_t N>
+class SpscQueue
+{
+	static_assert(N && (N & (N - 1)) == 0, "Capacity has to be a power of two");
+
+	std::array<T, N> buffer{};
+	alignas(64) std::atomic<std::size_t> head{ 0 };	//Next element to read, written by the consumer only
+	alignas(64) std::atomic<std::size_t> tail{ 0 };	//Next free slot, written by the producer only
+
+public:
+	//Producer side, returns false if the queue is full
+	bool push(T const& value)
+	{
+		auto t = tail.load(std::memory_order_relaxed);
+		if (t - head.load(std::memory_order_acquire) == N)
+			return false;
+
+		buffer[t & (N - 1)] = value;
+		tail.store(t + 1, std::memory_order_release);
+		return true;
+	}
+
+	//Consumer side, returns nullptr if the queue is empty
+	T const* front() const
+	{
+		auto h = head.load(std::memory_order_relaxed);
+		if (h == tail.load(std::memory_order_acquire))
+			return nullptr;
+
+		return &buffer[h & (N - 1)];
+	}
+
+	//Consumer side, the queue must not be empty
+	void pop()
+	{
+		head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+
+	bool pop(T& value)
+	{
+		auto const* element = front();
+		if (!element)
+			return false;
+
+		value = *element;
+		pop();
+		return true;
+	}
+
+	bool empty() const { return front() == nullptr; }
+};
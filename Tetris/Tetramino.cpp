@@ -1,77 +1,56 @@
-#include "Tetris.h"
+#include "Engine.h"
 
-void Tetris::Tetramino::init_sounds()
-{
-	std::vector<const char*> sounds_paths{
-		"resources/fall.wav",
-		"resources/rotate.wav",
-		"resources/move.wav" };
-
-	std::ranges::for_each(sounds_paths, [&](const char*& path) {
-		sounds.push_back(sEngine->addSoundSourceFromFile(path));
-		}
-	);
+#include <algorithm>
+#include <limits>
 
-	sounds[ROTATE]->setDefaultVolume(0.15f);
-	sounds[FALL]->setDefaultVolume(0.15f);
-}
-
-void Tetris::Tetramino::init_shader()
+//Builds the occupancy mask of the state with the pivot at the position, returns false if it is out of the walls or the rows.
+//The state is at most four bits wide, so it spans two words of a wide row at most
+template<std::uint32_t Width, std::uint32_t Height>
+static bool toMask(EngineBase::Rotations::State const& state, EngineBase::Pos const& pivot, std::int32_t& top, typename BasicField<Width, Height>::Mask& mask)
 {
-	this->shad = std::make_unique<Shader>("tetris_shad.vert", "tetramino_shad.frag");
-}
+	using Field = BasicField<Width, Height>;
+	using Word = typename Field::Word;
 
-Tetris::Tetramino::Tetramino(Field& fd, TetraminoPrototype const& prot, GLfloat dl)
-	: field(fd)
-{
-	this->init_sounds();
-	this->update(prot, dl);
-}
+	top = pivot.i + state.top;
+	auto shift = pivot.j + state.left + Field::WALL_WIDTH;
+	if (top < -Field::HIDDEN_ROWS || top >= (std::int32_t)Height || shift < 0 || shift + state.width > Field::ROW_BITS)
+		return false;
 
-Tetris::Tetramino::~Tetramino()
-{
-	this->sEngine->drop();
+	auto word = (std::size_t)(shift / Field::WORD_BITS);
+	auto offset = shift % Field::WORD_BITS;
+	for (std::size_t k = 0; k < mask.size(); ++k)
+	{
+		mask[k] = {};
+		mask[k][word] = (Word)((Word)state.mask[k] << offset);
+		if constexpr (Field::WORDS > 1)
+			if (offset + state.width > Field::WORD_BITS)
+				mask[k][word + 1] = (Word)((Word)state.mask[k] >> (Field::WORD_BITS - offset));
+	}
+	return true;
 }
 
-void Tetris::Tetramino::update(TetraminoPrototype const& shell, GLfloat dl)
+template<std::uint32_t Width, std::uint32_t Height>
+void BasicTetramino<Width, Height>::update(Field const& field, TetraminoPrototype const& shell, std::uint32_t dl)
 {
 	color = shell.color;
+	shape = shell.shape;
 	this->delay = dl;
 	isPlaced = false;
 
-	//Init shape coordinates
-	auto const& shape = shell.shape;
-	for (uint16_t i = 0; i < 4; ++i)
-	{
-		tiles_pos[i].i = shape[i] / 2;
-		tiles_pos[i].j = 4 + shape[i] % 2;
-	}
+	this->place(SPAWN_PIVOT, 0);
 
 	//Check if the tetramino can be added to the field
-	if (!this->canMoveTowards({ 0,0 }))
+	if (!this->canMoveTowards(field, { 0,0 }))
 	{
 		//If cannot then lift up the one by 1
 		this->advancePos({ -1, 0 });
 	}
 
-	shadow = getBottom();
-}
-
-void Tetris::Tetramino::drawTile(Tile const& tile, glm::vec2 const& position) const
-{
-	shad->use();
-
-	glm::mat4 model(1.f);
-	model = glm::translate(model, convert(glm::vec3(position + TILE_SIDE / 2.f, 0.f)));
-	model = glm::scale(model, glm::vec3(SCALE * glm::vec2(TILE_SIDE * 2 / WIDTH, TILE_SIDE * 2 / HEIGHT), 1.f));
-	shad->setUniform("model", model);
-	shad->setUniform("tileColor", tile.color);
-	shad->setUniform("texture1", TILES);
-	shad->setUniform("transparency", tile.transparency);
-	glDrawArrays(GL_TRIANGLES, 0, 6);
+	shadow = getBottom(field);
 }
 
-void Tetris::Tetramino::process_input(MovingType type)
+template<std::uint32_t Width, std::uint32_t Height>
+EngineBase::Events BasicTetramino<Width, Height>::process_input(Field const& field, MovingType type)
 {
 	using enum MovingType;
 	switch (type)
@@ -85,35 +64,42 @@ void Tetris::Tetramino::process_input(MovingType type)
 		break;
 
 	case LEFT:
-		this->moveLeft();
-		break;
+		return this->moveLeft(field);
 
 	case RIGHT:
-		this->moveRight();
-		break;
+		return this->moveRight(field);
 
 	case ROTATE:
-		this->rotate();
-		break;
+		return this->rotate(field);
 
 	case FALL:
-		this->fall();
-		break;
+		return this->fall();
 	}
+	return NO_EVENT;
 }
 
-void Tetris::Tetramino::advancePos(Pos const& direction)
+//Puts the tetramino in the rotation state at the pivot, the field is not checked
+template<std::uint32_t Width, std::uint32_t Height>
+void BasicTetramino<Width, Height>::place(Pos const& p, std::uint32_t r)
 {
-	std::ranges::for_each(tiles_pos, [&](Pos& pos) {
-		pos.i += direction.i;
-		pos.j += direction.j;
-		}
-	);
+	pivot = p;
+	rotation = r;
+
+	auto const& cells = getState().cells;
+	for (std::size_t k = 0; k < tiles_pos.size(); ++k)
+		tiles_pos[k] = { pivot.i + cells[k].i, pivot.j + cells[k].j };
 }
 
-bool Tetris::Tetramino::move(Pos const& direction)
+template<std::uint32_t Width, std::uint32_t Height>
+void BasicTetramino<Width, Height>::advancePos(Pos const& direction)
 {
-	if (canMoveTowards(direction))
+	this->place({ pivot.i + direction.i, pivot.j + direction.j }, rotation);
+}
+
+template<std::uint32_t Width, std::uint32_t Height>
+bool BasicTetramino<Width, Height>::move(Field const& field, Pos const& direction)
+{
+	if (canMoveTowards(field, direction))
 	{
 		advancePos(direction);
 		return true;
@@ -121,31 +107,33 @@ bool Tetris::Tetramino::move(Pos const& direction)
 	return false;
 }
 
-void Tetris::Tetramino::moveLeft()
+template<std::uint32_t Width, std::uint32_t Height>
+EngineBase::Events BasicTetramino<Width, Height>::moveLeft(Field const& field)
 {
-	if (this->move({ 0, -1 }))
-	{
-		updateShadow();
-		sEngine->play2D(sounds[MOVE]);
-	}
+	if (!this->move(field, { 0, -1 }))
+		return NO_EVENT;
+
+	updateShadow(field);
+	return MOVED;
 }
 
-void Tetris::Tetramino::moveRight()
+template<std::uint32_t Width, std::uint32_t Height>
+EngineBase::Events BasicTetramino<Width, Height>::moveRight(Field const& field)
 {
-	if (this->move({ 0, 1 }))
-	{
-		updateShadow();
-		sEngine->play2D(sounds[MOVE]);
-	}
+	if (!this->move(field, { 0, 1 }))
+		return NO_EVENT;
+
+	updateShadow(field);
+	return MOVED;
 }
 
-void Tetris::Tetramino::moveDown()
+template<std::uint32_t Width, std::uint32_t Height>
+void BasicTetramino<Width, Height>::moveDown(Field const& field)
 {
-	fallTimer.stop();
-	if(fallTimer.getElapsedTime() > delay)
+	if (++fallTimer >= delay)
 	{
-		fallTimer.start();
-		if (!move({ 1, 0 })) //If cannot move down further
+		fallTimer = 0;
+		if (!move(field, { 1, 0 })) //If cannot move down further
 		{
 			//Set flag that tetramino is placed
 			isPlaced = true;
@@ -153,111 +141,120 @@ void Tetris::Tetramino::moveDown()
 	}
 }
 
-void Tetris::Tetramino::rotate()
+//Turns clockwise at the first of the SRS kicks which fits
+template<std::uint32_t Width, std::uint32_t Height>
+EngineBase::Events BasicTetramino<Width, Height>::rotate(Field const& field)
 {
-	//Temp tetramino's tiles coordinates
-	auto t_tile_coords = tiles_pos;
-
-	//Center of rotation
-	Pos const& p = tiles_pos[1];
-	for (auto& tile : t_tile_coords) {
-		auto tile_i = tile.i;
-
-		tile.i = p.i - (tile.j - p.j);
-		tile.j = p.j + (tile_i - p.i);
-		if (!tileIsAllowed(tile))
-			return;
-	}
+	auto next = (rotation + 1) % Rotations::STATES_NUMBER;
+	for (auto const& kick : Rotations::KICKS[(std::size_t)shape][rotation])
+	{
+		Pos kicked{ pivot.i + kick.i, pivot.j + kick.j };
+		if (!fitsAt(field, kicked, next))
+			continue;
 
-	tiles_pos = t_tile_coords;
-	updateShadow();
-	sEngine->play2D(sounds[ROTATE]);
+		this->place(kicked, next);
+		updateShadow(field);
+		return ROTATED;
+	}
+	return NO_EVENT;
 }
 
-void Tetris::Tetramino::fall()
+template<std::uint32_t Width, std::uint32_t Height>
+EngineBase::Events BasicTetramino<Width, Height>::fall()
 {
 	//Update the position to the bottom one
-	this->tiles_pos = this->shadow;
+	this->advancePos({ shadow[0].i - tiles_pos[0].i, 0 });
 	isPlaced = true;
 
-	//Play fall sound
-	sEngine->play2D(sounds[FALL]);
-
 	//Reset timer
-	fallTimer.start();
-}
-
-void Tetris::Tetramino::fast()
-{
-	this->delay = 0.05f;
+	fallTimer = 0;
+	return FELL;
 }
 
-void Tetris::Tetramino::slow()
+template<std::uint32_t Width, std::uint32_t Height>
+void BasicTetramino<Width, Height>::fast()
 {
-	this->delay = 0.7f;
+	this->delay = fastDelay;
 }
 
-void Tetris::Tetramino::updateShadow()
+template<std::uint32_t Width, std::uint32_t Height>
+void BasicTetramino<Width, Height>::slow()
 {
-	this->shadow = this->getBottom();
+	this->delay = slowDelay;
 }
 
-void Tetris::Tetramino::removeFromField() const
+template<std::uint32_t Width, std::uint32_t Height>
+void BasicTetramino<Width, Height>::updateShadow(Field const& field)
 {
-	this->fillWith(NONE);
+	this->shadow = this->getBottom(field);
 }
 
-//Return false if there was an error with adding tetramino at the field
-bool Tetris::Tetramino::addToField() const
+//Return false if there was no place for the tetramino at the field
+template<std::uint32_t Width, std::uint32_t Height>
+bool BasicTetramino<Width, Height>::addToField(Field& field) const
 {
 	//Add only if there is a place for it
-	if (!canMoveTowards({ 0,0 }))
-		return false ;
+	if (!canMoveTowards(field, { 0,0 }))
+		return false;
 
-	this->fillWith(this->color);
+	//Tiles above the field are lost, it's a game over anyway
+	for (auto const& pos : tiles_pos)
+		if (pos.i >= 0)
+			field.put(pos, this->color);
 	return true;
 }
 
-//Fill the tetramino with the given color
-void Tetris::Tetramino::fillWith(TileColor col) const
+template<std::uint32_t Width, std::uint32_t Height>
+bool BasicTetramino<Width, Height>::fitsAt(Field const& field, Pos const& p, std::uint32_t r) const
 {
-	for (uint16_t i = 0; i < 4; ++i)
-	{
-		auto const& tetr_tile = tiles_pos[i];
-		auto const& shadow_tile = shadow[i];
-
-		//Fill the shadow's tiles only when they would not overlap the main ones
-		if(!std::ranges::contains(tiles_pos, shadow_tile))
-			field[shadow_tile.i][shadow_tile.j] = { col, 0.5f };
-		field[tetr_tile.i][tetr_tile.j] = { col, 0.f };
-	}
+	std::int32_t top;
+	typename Field::Mask mask;
+	return toMask<Width, Height>(Rotations::STATES[(std::size_t)shape][r], p, top, mask) && !field.collides(top, mask);
 }
 
-bool Tetris::Tetramino::tileIsAllowed(Pos const& pos) const
+template<std::uint32_t Width, std::uint32_t Height>
+bool BasicTetramino<Width, Height>::canMoveTowards(Field const& field, Pos const& direction) const
 {
-	return pos.j >= 0 && pos.j < GRID_NUMBER_J && pos.i < GRID_NUMBER_I &&
-		field[pos.i][pos.j].color == NONE;
+	return fitsAt(field, { pivot.i + direction.i, pivot.j + direction.j }, rotation);
 }
 
-bool Tetris::Tetramino::canMoveTowards(Pos const& direction) const
+//Rows the tetramino can move down. The surface gives it at once while every column of the tetramino is above it,
+//a tetramino under an overhang slides its mask down instead
+template<std::uint32_t Width, std::uint32_t Height>
+std::int32_t BasicTetramino<Width, Height>::getDropDistance(Field const& field) const
 {
-	return std::ranges::all_of(tiles_pos, [&](Pos const& pos) {
-		return tileIsAllowed({ pos.i + direction.i, pos.j + direction.j });
+	auto const& state = getState();
+	auto distance = std::numeric_limits<std::int32_t>::max();
+	for (std::int32_t c = 0; c < state.width; ++c)
+	{
+		auto surface = field.surface[pivot.j + state.left + c];
+		auto bottom = pivot.i + state.bottoms[c];
+		if (bottom >= surface)
+		{
+			std::int32_t top;
+			typename Field::Mask mask;
+			toMask<Width, Height>(state, pivot, top, mask);
+
+			distance = 0;
+			while (!field.collides(top + distance + 1, mask))
+				++distance;
+			return distance;
 		}
-	);
+		distance = std::min(distance, surface - 1 - bottom);
+	}
+	return distance;
 }
 
-std::array<Tetris::Tetramino::Pos, 4> Tetris::Tetramino::getBottom() const
+template<std::uint32_t Width, std::uint32_t Height>
+std::array<EngineBase::Pos, 4> BasicTetramino<Width, Height>::getBottom(Field const& field) const
 {
-	auto copy_tiles_pos = tiles_pos;
-
-	auto canMoveDown = [&]() {
-		return std::ranges::all_of(copy_tiles_pos, [&](Pos const& pos) {
-			return pos.i + 1 < GRID_NUMBER_I && field[pos.i + 1LL][pos.j].color == NONE;
-			});
-		};
-	while (canMoveDown())
-		std::ranges::for_each(copy_tiles_pos, [](Pos& pos) { ++pos.i; });
+	auto distance = getDropDistance(field);
 
+	auto copy_tiles_pos = tiles_pos;
+	std::ranges::for_each(copy_tiles_pos, [distance](Pos& pos) { pos.i += distance; });
 	return copy_tiles_pos;
 }
+
+template struct BasicTetramino<10, 20>;
+template struct BasicTetramino<64, 128>;
+template struct BasicTetramino<256, 512>;
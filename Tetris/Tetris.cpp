@@ -5,71 +5,97 @@ void Tetris::keyboard_callback(GLFWwindow*, int key, int scancode, int action, i
 {
 	if (key == GLFW_KEY_ESCAPE && action == GLFW_PRESS)
 	{
-		tetris.isGame = false;
 		glfwSetWindowShouldClose(tetris.window, true);
 		return;
 	}
-	if (!tetris.isGame)
+	if (key == GLFW_KEY_F12 && action == GLFW_PRESS)
+	{
+		tetris.saveProfile();
+		return;
+	}
+	if (key == GLFW_KEY_TAB && action == GLFW_PRESS)
+	{
+		tetris.botPlaying = !tetris.botPlaying;
+		tetris.botThink = true;
+		return;
+	}
+	if (key == GLFW_KEY_BACKSPACE && action == GLFW_PRESS)
+	{
+		tetris.undo = true;
+		return;
+	}
+	if (tetris.engine.isOver() || tetris.botPlaying)
 		return;
 
-	using enum Tetris::Tetramino::MovingType;
+	using enum Engine::MovingType;
+
+	//Inputs are applied by the engine at the tick they fall into
+	auto push = [time = glfwGetTime()](Engine::MovingType move) {
+		tetris.inputs.push({ move, time });
+		};
 
-	static std::vector<Tetris::Tetramino::MovingType> moves;
 	if (key == GLFW_KEY_LEFT && (action == GLFW_PRESS || action == GLFW_REPEAT))
-		moves.push_back(LEFT);
+		push(LEFT);
 
 	if (key == GLFW_KEY_RIGHT && (action == GLFW_PRESS || action == GLFW_REPEAT))
-		moves.push_back(RIGHT);
+		push(RIGHT);
 
 	if (key == GLFW_KEY_DOWN && (action == GLFW_PRESS || action == GLFW_REPEAT))
-		moves.push_back(FAST);
+		push(FAST);
 
 	if (key == GLFW_KEY_DOWN && action == GLFW_RELEASE)
-		moves.push_back(SLOW);
+		push(SLOW);
 
 	if (key == GLFW_KEY_UP && action == GLFW_PRESS)
-		moves.push_back(ROTATE);
+		push(ROTATE);
 
 	if (key == GLFW_KEY_SPACE && action == GLFW_PRESS)
-		moves.push_back(FALL);
+		push(FALL);
+}
 
-	for (auto move : moves)
-		tetris.tetramino.process_input(move);
-	moves.clear();
+//A minimized window has no framebuffer, the picture is kept for the restored one
+void Tetris::framebuffer_size_callback(GLFWwindow*, int width, int height)
+{
+	if (width > 0 && height > 0 && tetris.renderer)
+		tetris.renderer->resize(width, height);
 }
 
-glm::vec3 Tetris::convert(glm::vec3 const& vec)
+///////////////// Private member methods /////////////////////
+
+//Maps the bundle made by tetris_pack, without it the resources are decoded now
+void Tetris::init_assets()
 {
-	glm::vec3 result{};
-	// Normalize window coordinates to [0, 1]
-	glm::vec2 normalized = glm::vec2(vec.x / WIDTH, vec.y / HEIGHT) * SCALE;
+	this->assets = Bundle::map(Packer::BUNDLE_PATH);
+	if (assets)
+		return;
 
-	// Convert to OpenGL coordinates [-1, 1]
-	result = glm::vec3(
-		normalized.x * 2.f - 1.f,
-		1.f - normalized.y * 2.f, // Inver
-		0.f);
+	std::cerr << "No asset bundle at " << Packer::BUNDLE_PATH << ", decoding the resources" << std::endl;
 
-	return result;
+	//Sounds are decoded by a device without an output, the one which plays them is made later
+	auto* decoder = irrklang::createIrrKlangDevice(irrklang::ESOD_NULL);
+	if (!decoder)
+	{
+		std::cerr << "Failed to initialize sound engine" << std::endl;
+		system("pause");
+		exit(1);
+	}
+	this->assets = Bundle::fromMemory(Packer::pack(*decoder));
+	decoder->drop();
 }
 
-///////////////// Private member methods /////////////////////
-
+//The pixels stay in the bundle
 GLFWimage Tetris::load_icon() const
 {
-	GLFWimage icon{};
-	stbi_set_flip_vertically_on_load(true);
-	icon.pixels = stbi_load("resources/Icon.png", &icon.width, &icon.height, nullptr, 4);
-	if (!icon.pixels)
+	auto const* icon = assets->find(Packer::ICON.name);
+	if (!icon)
 	{
 		std::cerr << "\n\nICON IMAGE WAS NOT LOADED\n\n";
 		return GLFWimage{};
 	}
 
-	return icon;
+	return { (int)icon->width, (int)icon->height, (unsigned char*)assets->getData(*icon) };
 }
 
-//Inits
 void Tetris::init_window()
 {
 	glfwInit();
@@ -79,10 +105,12 @@ void Tetris::init_window()
 
 	this->window = glfwCreateWindow(WIDTH, HEIGHT, TITLE, nullptr, nullptr);
 	glfwMakeContextCurrent(window);
+	glfwSwapInterval(VSYNC);
 	glfwSetKeyCallback(window, keyboard_callback);
+	glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
 	GLFWimage icon = load_icon();
-	glfwSetWindowIcon(window, 1, &icon);
-	stbi_image_free(icon.pixels);
+	if (icon.pixels)
+		glfwSetWindowIcon(window, 1, &icon);
 
 	if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
 	{
@@ -92,293 +120,343 @@ void Tetris::init_window()
 	}
 }
 
-void Tetris::init_buffers() const
+//The window's context has to be current
+void Tetris::init_renderer()
 {
-	constexpr GLfloat vertices[] =
-	{
-		//Triangles				//Textures		//Tiles texture
-		-0.5f, -0.5f, 0.f,		0.f, 0.f,		0.f, 0.f,
-		-0.5f, 0.5f, 0.f,		0.f, 1.f,		0.f, 1.f,
-		0.5f, 0.5f, 0.f,		1.f, 1.f,		0.125f, 1.f,
-
-		-0.5f, -0.5f, 0.f,		0.f, 0.f,		0.f, 0.f,
-		0.5f, -0.5f, 0.f,		1.f, 0.f,		0.125f, 0.f,
-		0.5f, 0.5f, 0.f,		1.f, 1.f,		0.125f, 1.f
-	};
-
-	GLuint VBO;
-	GLuint VAO;
-	glGenBuffers(1, &VBO);
-	glGenVertexArrays(1, &VAO);
-
-	glBindVertexArray(VAO);
-
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+	this->renderer = std::make_unique<Renderer>(*assets);
 
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 7 * sizeof(GLfloat), nullptr);
-	glEnableVertexAttribArray(0);
-
-	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 7 * sizeof(GLfloat), (void*)(3 * sizeof(GLfloat)));
-	glEnableVertexAttribArray(1);
-
-	glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 7 * sizeof(GLfloat), (void*)(5 * sizeof(GLfloat)));
-	glEnableVertexAttribArray(2);
+	//The framebuffer is larger than the window on high DPI screens
+	int width, height;
+	glfwGetFramebufferSize(window, &width, &height);
+	renderer->resize(width, height);
+	this->gpuTimer = std::make_unique<GpuTimer>("render");
 }
 
-void Tetris::init_textures() const
+void Tetris::init_sounds()
 {
-	std::vector<const char*> textures_paths{
-		"resources/tiles.png", 
-		"resources/frame.png", 
-		"resources/background.png" };
-
-	std::vector<GLuint> textures(textures_paths.size());
-	glGenTextures((GLsizei)textures_paths.size(), textures.data());
-
-	GLint width;
-	GLint height;
-	GLint nrChannels;
-	stbi_set_flip_vertically_on_load(true);
-	for (GLenum i = 0; i < textures_paths.size(); ++i)
+	this->audio = std::make_unique<Audio>(*assets);
+	if (!audio->isAvailable())
 	{
-		//Enable transparency
-		glEnable(GL_BLEND);
-		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-		glActiveTexture(GL_TEXTURE0 + i);
-		glBindTexture(GL_TEXTURE_2D, textures[i]);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_BORDER);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
-		auto data = stbi_load(textures_paths[i], &width, &height, &nrChannels, 0);
-		if (data)
-		{
-			GLenum format = GL_RGBA;
-			if (nrChannels == 3)
-				format = GL_RGB;
-
-			glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-			glGenerateMipmap(GL_TEXTURE_2D);
-			stbi_image_free(data);
-		}
-		else std::cerr << "Failed to load texture" << std::endl;
+		std::cerr << "Failed to initialize sound engine" << std::endl;
+		system("pause");
+		exit(1);
 	}
 }
 
-void Tetris::init_shader()
+void Tetris::render() const
 {
-	this->shad = std::make_unique<Shader>("tetris_shad.vert", "tetris_shad.frag");
+	Profiler::Zone zone("render");
+
+	gpuTimer->begin();
+	renderer->render(engine, previous_pos, interpolate, timestep.getAlpha());
+	gpuTimer->end();
 }
 
-void Tetris::init_sounds()
+//Runs all the engine ticks which are due since the last frame
+void Tetris::updateEngine()
 {
-	if (!sEngine)
-	{
-		std::cerr << "Failed to initialize sound engine" << std::endl;
-		system("pause");
-		exit(1);
-	}
-	
-	std::vector<const char*> sounds_paths{
-		"resources/soundtrack.mp3",
-		"resources/line_clear.wav",
-		"resources/end_game.wav" 
-	};
+	Profiler::Zone zone("updateEngine");
 
-	sounds.reserve(sounds_paths.size());
-	std::ranges::for_each(sounds_paths, [&](const char*& path) {
-		sounds.push_back(sEngine->addSoundSourceFromFile(path));
+	if (undo)
+		this->takeBack();
+
+	deltaTime.stop();
+	auto ticks = timestep.advance(deltaTime.getElapsedTime());
+	deltaTime.start();
+
+	//The last tick ends before now by the time carried over to the next one
+	double const tick = 1. / engine.getTickRate();
+	double tickEnd = deltaTime.currTime - (timestep.getAlpha() + ticks - 1) * tick;
+	for (std::uint32_t i = 0; i < ticks; ++i, tickEnd += tick)
+	{
+		//Every event captured before the end of the tick is applied at it
+		std::array<Engine::MovingType, 32> moves;
+		size_t count = 0;
+		for (auto const* event = inputs.front(); event && event->time <= tickEnd && count < moves.size(); event = inputs.front())
+		{
+			moves[count++] = event->move;
+			inputs.pop();
 		}
-	);
 
-	sounds[LINE_CLEAR]->setDefaultVolume(0.6f);
-	sounds[GAME_OVER]->setDefaultVolume(0.15f);
+		previous_pos = engine.getTetramino().tiles_pos;
+		recording.record(engine.getTick(), std::span(moves.data(), count));
+		this->onStep(engine.step(std::span(moves.data(), count)));
+	}
 }
 
-void Tetris::init_tetraminos()
+//Same as updateEngine but the inputs are taken from the replay
+void Tetris::updateReplay(ReplayPlayer& player)
 {
-	next_tetraminos.reserve(3);
+	Profiler::Zone zone("updateReplay");
+
+	deltaTime.stop();
+	auto ticks = timestep.advance(deltaTime.getElapsedTime());
+	deltaTime.start();
+
+	for (std::uint32_t i = 0; i < ticks; ++i)
+	{
+		previous_pos = engine.getTetramino().tiles_pos;
+		auto events = player.step();
+		engine = player.getEngine();
+		this->onStep(events);
+	}
 
-	//Push 3 tetraminos to the vector
-	for(size_t i = 0; i < 3; ++i)
-		next_tetraminos.push_back(TetraminoPrototype{});
+	//Keys do not control the replay
+	Engine::InputEvent event;
+	while (inputs.pop(event));
 }
 
-//Drawings
-void Tetris::drawBackground() const
+//Plans every new tetramino once and queues the moves as if they were pressed now
+void Tetris::updateBot()
 {
-	shad->use();
-
-	glm::mat4 model(1.f);
-	model = glm::scale(model, glm::vec3(SCALE, 1.f));
+	if (!botPlaying || !botThink || engine.isOver())
+		return;
 
-	shad->setUniform("model", model);
-	shad->setUniform("texture1", BACKGROUND);
-	glDrawArrays(GL_TRIANGLES, 0, 6);
+	auto plan = bot.think(engine);
+	for (auto move : plan.getMoves())
+		inputs.push({ move, glfwGetTime() });
+	botThink = false;
 }
 
-void Tetris::drawFrame() const
+//Goes back to the start of the last placed tetramino, a game over goes back to the start of the one which ended it
+void Tetris::takeBack()
 {
-	shad->use();
-
-	glm::mat4 model(1.f);
-	model = glm::scale(model, glm::vec3(SCALE, 1.f));
+	undo = false;
+	if (!history.rewind(engine, engine.isOver() || history.size() == 1 ? 0 : 1))
+		return;
 
-	shad->setUniform("model", model);
-	shad->setUniform("texture1", FRAME);
-	glDrawArrays(GL_TRIANGLES, 0, 6);
-}   
+	rewound = true;
+	interpolate = false;
+	botThink = true;
 
-void Tetris::drawField() const
-{
-	bool tetramino_was_drawn = tetramino.addToField();
-	for (GLuint i = 0; i < GRID_NUMBER_I; ++i)
-		for (GLuint j = 0; j < GRID_NUMBER_J; ++j)
-			if (auto const& tile = this->field[i][j]; tile.color != NONE)
-				tetramino.drawTile(tile, { 28 + (GLfloat)j * Tetramino::TILE_SIDE,
-					31 + (GLfloat)i * Tetramino::TILE_SIDE });
-
-	//Do not remove anything if tetramino wasn't added to the field
-	if(tetramino_was_drawn)
-		this->tetramino.removeFromField();
+	//Keys pressed for the tetramino which was taken back
+	Engine::InputEvent event;
+	while (inputs.pop(event));
 }
 
-void Tetris::drawNextTetraminos() const
+void Tetris::onStep(Engine::Events events)
 {
-	std::ranges::for_each(next_tetraminos, [this, i = 1](TetraminoPrototype const& tetr) mutable {
-		std::ranges::for_each(tetr.shape, [&](GLuint shape_ind)  {
-			tetramino.drawTile({ tetr.color, 0.f }, {
-				250.f + Tetramino::TILE_SIDE * (shape_ind % 2),
-				90.f * i + Tetramino::TILE_SIDE * (shape_ind / 2) });
-			}
-		);
-		++i;
-		}
-	);
+	//A new tetramino has nothing to be interpolated from
+	interpolate = !(events & Engine::PLACED);
+	if (events & Engine::PLACED)
+		botThink = true;
+	if ((events & Engine::PLACED) && !(events & Engine::GAME_OVER))
+		history.push(engine);
+	this->playSounds(events);
+
+	if (events & Engine::GAME_OVER)
+		this->saveRecording();
 }
 
-void Tetris::render() const
+//Keeps the last played game to be watched or simulated again
+void Tetris::saveRecording()
 {
-	this->drawBackground();
-	this->drawField();
-	this->drawFrame();
-	this->drawNextTetraminos();
+	//Inputs of a game which was taken back do not play it again
+	if (rewound)
+		return;
+
+	recording.finish(engine.getTick());
+	if (!recording.save(RECORDING_PATH))
+		std::cerr << "Failed to save the replay to " << RECORDING_PATH << std::endl;
 }
 
-void Tetris::updateTetramino()
+void Tetris::saveProfile() const
 {
-	//Move tetramino down
-	tetramino.moveDown();
+	if (!Profiler::isEnabled())
+		return;
 
-	//If one is placed and it's not a game over
-	if (tetramino.isPlaced && isGame)
-	{
-		//Leave it at its place
-		tetramino.addToField();
-		
-		//Check lines to clear
-		clearLines();
-
-		//And update
-		updateNextTetraminos();
-	}
-	//...
-	//Do nothing if either tetramino is not placed or it's a game over
+	if (Profiler::dump(PROFILE_PATH))
+		std::cout << "Profile saved to " << PROFILE_PATH << std::endl;
+	else
+		std::cerr << "Failed to save the profile to " << PROFILE_PATH << std::endl;
 }
 
-//Updates the current tetramino and the next tetraminos shown on the screen
-void Tetris::updateNextTetraminos()
+void Tetris::pollEvents()
 {
-	tetramino.update(next_tetraminos.front(), tetramino.delay);
-	std::move(next_tetraminos.begin() + 1, next_tetraminos.end(), next_tetraminos.begin());
-	next_tetraminos.back() = TetraminoPrototype{};
+	Profiler::Zone zone("glfwPollEvents");
+	glfwPollEvents();
 }
 
-void Tetris::clearLines()
+//Shows the frame, the time it took to get to the first one is reported
+void Tetris::present()
 {
-	//If tetramino is not placed at the field then no need to check for lines to clear
-	if (!tetramino.isPlaced)
-		return;
-
-	bool line_cleared = false;
-	for (auto row = field.begin() + 3; row != field.end(); ++row)
-		if (std::ranges::all_of(*row, [](Tile tile) {return tile.color != NONE; }))
-		{	
-			std::ranges::move(field.begin(), row, field.begin() + 1);
-			std::ranges::fill(field.front(), Tile{ NONE, 0.f });
-			line_cleared = true;
-		}
-
-	if (line_cleared)
 	{
-		tetramino.updateShadow();
-		
-		//Stop line-clearing sound if it's currently playing
-		if(sEngine->isCurrentlyPlaying(sounds[LINE_CLEAR]))
-			sEngine->stopAllSoundsOfSoundSource(sounds[LINE_CLEAR]);
-		//And then play it
-		playSound(LINE_CLEAR);
+		Profiler::Zone zone("glfwSwapBuffers");
+		glfwSwapBuffers(window);
 	}
-}
+	if (presented)
+		return;
 
-void Tetris::playSound(SoundType type)
-{
-	sEngine->play2D(sounds[type]);
+	presented = true;
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+	std::cout << "First frame in " << elapsed.count() << " ms" << std::endl;
 }
 
-//Checks whether a tetramino was placed out of the upper bounds of the field
-bool Tetris::checkForGameOver()
+void Tetris::playSounds(Engine::Events events)
 {
-	isGame = std::ranges::all_of(tetramino.tiles_pos, [](Tetramino::Pos const& tile_pos) {
-		return tile_pos.i >= 0;
-		}
-	);
+	if (events & Engine::MOVED)
+		audio->play(Audio::MOVE);
+
+	if (events & Engine::ROTATED)
+		audio->play(Audio::ROTATE);
 
-	if(!isGame)
+	if (events & Engine::FELL)
+		audio->play(Audio::FALL);
+
+	//A line clear cuts the previous one, it has a single voice
+	if (events & Engine::LINE_CLEAR)
+		audio->play(Audio::LINE_CLEAR);
+
+	if (events & Engine::GAME_OVER)
 	{
-		playSound(GAME_OVER);
+		audio->play(Audio::GAME_OVER);
 		std::cout << "\n\nEND GAME!!!\n\n";
-		return true;
 	}
-	return false;
 }
 
-Tetris::Tetris()
+Tetris::Tetris(std::uint32_t tickRate)
+	: engine(std::random_device{}(), tickRate), timestep(tickRate), recording(engine.getSeed(), tickRate)
 {
+	Profiler::nameThread("main");
+	history.push(engine);
+
+	this->init_assets();
 	this->init_window();
-	this->init_buffers();
-	this->init_textures();
-	this->init_shader();
+	this->init_renderer();
 	this->init_sounds();
-	this->init_tetraminos();
-	this->tetramino.init_shader();
 }
 
 Tetris::~Tetris()
 {
+	//GL objects go before the context
+	gpuTimer.reset();
+	renderer.reset();
 	glfwTerminate();
-	this->sEngine->drop();
 }
 
 void Tetris::game()
 {
-	sEngine->play2D(sounds[SOUNDTRACK], true);
+	audio->play(Audio::SOUNDTRACK);
 	while (!glfwWindowShouldClose(window))
 	{
+		Profiler::Zone zone("frame");
 		this->render();
+		this->updateEngine();
+		this->updateBot();
 
-		//Stop updating objects if game is over
-		if(isGame)
+		this->pollEvents();
+		this->present();
+	}
+
+	//The game was left before it was over
+	if (!engine.isOver())
+		this->saveRecording();
+	this->saveProfile();
+}
+
+void Tetris::watch(Replay const& replay)
+{
+	ReplayPlayer player(replay);
+	engine = player.getEngine();
+	timestep = FixedTimestep(replay.getTickRate());
+
+	audio->play(Audio::SOUNDTRACK);
+	while (!glfwWindowShouldClose(window))
+	{
+		Profiler::Zone zone("frame");
+		this->render();
+		this->updateReplay(player);
+
+		this->pollEvents();
+		this->present();
+	}
+	this->saveProfile();
+}
+
+//Bots play the boards at the fast speed, so every tetramino is seen falling. The keys do not control them.
+//The bots search on the thread pool while their boards go on, a plan is applied at the first tick after it's found
+void Tetris::spectate(std::uint32_t boards)
+{
+	Bot::Settings settings;
+	settings.depth = 1;
+
+	struct Board {
+		Engine engine;
+		Bot bot;
+		Bot::Plan plan;	//Written by the search, read once 'ready' is set
+		std::uint64_t planned = ~0ull;	//Number of the tetramino which was searched for
+		bool thinking = false;
+		std::atomic<bool> ready{ false };
+
+		Board(Engine const& engine, ThreadPool& pool, Bot::Settings const& settings) : engine(engine), bot(pool, settings) {}
+	};
+	std::vector<std::unique_ptr<Board>> games;
+	std::vector<Engine const*> views;
+	games.reserve(boards);
+	for (std::uint32_t k = 0; k < boards; ++k)
+		views.push_back(&games.emplace_back(std::make_unique<Board>(Engine(std::random_device{}(), engine.getTickRate()), pool, settings))->engine);
+
+	//The search gets a copy of the board, which goes on falling while it runs
+	auto think = [this](Board& board) {
+		board.planned = board.engine.getPieces();
+		board.thinking = true;
+		board.ready.store(false, std::memory_order_relaxed);
+		pool.submit([&board, snapshot = board.engine]() {
+			board.plan = board.bot.think(snapshot);
+			std::ranges::replace(board.plan.moves, Engine::MovingType::FALL, Engine::MovingType::FAST);
+			board.ready.store(true, std::memory_order_release);
+			}
+		);
+		};
+
+	audio->play(Audio::SOUNDTRACK);
+	while (!glfwWindowShouldClose(window))
+	{
+		Profiler::Zone zone("frame");
 		{
-			deltaTime.stop();
-			
-			this->updateTetramino();
-			this->checkForGameOver();
+			Profiler::Zone zone("render");
+			gpuTimer->begin();
+			renderer->renderGrid(views);
+			gpuTimer->end();
+		}
 
-			deltaTime.start();
+		deltaTime.stop();
+		auto ticks = timestep.advance(deltaTime.getElapsedTime());
+		deltaTime.start();
+		{
+			Profiler::Zone zone("updateBoards");
+			for (std::uint32_t i = 0; i < ticks; ++i)
+				for (auto& game : games)
+				{
+					auto& board = *game;
+					if (board.engine.isOver())
+						continue;
+
+					//A plan of a tetramino which was placed before it was found is thrown away
+					Bot::Plan plan;
+					if (board.thinking && board.ready.load(std::memory_order_acquire))
+					{
+						board.thinking = false;
+						if (board.planned == board.engine.getPieces())
+							plan = board.plan;
+					}
+					if (!board.thinking && board.planned != board.engine.getPieces())
+						think(board);
+
+					board.engine.step(plan.getMoves());
+				}
 		}
 
-		glfwPollEvents();
-		glfwSwapBuffers(window);
+		Engine::InputEvent event;
+		while (inputs.pop(event));
+
+		this->pollEvents();
+		this->present();
 	}
-}
\ No newline at end of file
+
+	//The searches which are still running write to the boards
+	for (auto const& game : games)
+		while (game->thinking && !game->ready.load(std::memory_order_acquire))
+			std::this_thread::yield();
+	this->saveProfile();
+}
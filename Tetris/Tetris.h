@@ -4,14 +4,23 @@
 #include <iostream>
 #include <array>
 #include <print>
-#include <random>
 #include <ranges>
 #include <thread>
 #include <chrono>
-#include <irrKlang.h>
-
-#include "stb_image.h"
-#include "Shader.hpp"
+#include <vector>
+
+#include "Audio.h"
+#include "Bot.h"
+#include "Bundle.h"
+#include "Engine.h"
+#include "FixedTimestep.hpp"
+#include "GpuTimer.hpp"
+#include "Packer.h"
+#include "Profiler.h"
+#include "Renderer.h"
+#include "Replay.h"
+#include "Rewind.hpp"
+#include "SpscQueue.hpp"
 #include "Timer.hpp"
 
 class Tetris
@@ -20,181 +29,80 @@ public:
 	//Window settings
 	GLFWwindow* window;
 	static constexpr const char* TITLE = "Tetris";
-	static constexpr glm::vec2 SCALE = glm::vec2(2.f);
-	static constexpr GLsizei WIDTH = (GLsizei)(320 * SCALE.x);
-	static constexpr GLsizei HEIGHT = (GLsizei)(480 * SCALE.y);
-	static constexpr GLuint GRID_NUMBER_J = 10;
-	static constexpr GLuint GRID_NUMBER_I = 20; 
+	static constexpr GLsizei WIDTH = Renderer::WIDTH;
+	static constexpr GLsizei HEIGHT = Renderer::HEIGHT;
+	static constexpr bool VSYNC = true;
 	
 private:
-	//Enumerations
-	enum Textures
-	{
-		TILES,
-		FRAME,
-		BACKGROUND
-	};
-
-	enum TileColor : GLuint
-	{
-		NONE,
-		PURPLE,
-		RED,
-		GREEN,
-		YELLOW,
-		SKY,
-		ORANGE,
-		BLUE,
-		COLORS_END
-	};
-
-	enum SoundType
-	{
-		SOUNDTRACK,
-		LINE_CLEAR,
-		GAME_OVER
-	};
-
-	//Describes tile settings at field
-	struct Tile{
-		TileColor color;
-		GLfloat transparency;
-	};
-
-	//Displays information about the next tetraminos
-	struct TetraminoPrototype {
-		TileColor color = (TileColor)((rd() % (TileColor::COLORS_END - 1)) + 1);
-		std::array<GLuint, 4> shape = (Tetramino::SHAPES[rd() % Tetramino::SHAPES.size()]);
-	};
-
-	using Field = std::array<std::array<Tile, GRID_NUMBER_J>, GRID_NUMBER_I>;
-	struct Tetramino
-	{
-		static constexpr std::array<std::array<GLuint, 4>, 7> SHAPES{ {
-				{ 0, 2, 4, 6 },		//I
-				{ 0, 2, 4, 5 },		//L
-				{ 1, 3, 4, 5 },		//J
-				{ 1, 2, 3, 5 },		//T
-				{ 0, 1, 2, 3 },		//O
-				{ 1, 2, 3, 4 },		//S
-				{ 0, 2, 3, 5 } 		//Z
-			} };
-		static constexpr GLfloat TILE_SIDE = 18;
-
-		enum class MovingType
-		{
-			LEFT,
-			RIGHT,
-			FAST,
-			SLOW,
-			ROTATE,
-			FALL
-		};
-
-		enum SoundType {
-			FALL,
-			ROTATE,
-			MOVE
-		};
-
-		struct Pos {
-			GLint i;
-			GLint j;
-
-			bool operator==(Pos const& other) const = default;
-		};//Represent position as 'i', 'j' indices
-		
-		//Properties
-		Tetris::Field& field;
-		TileColor color;
-		std::array<Pos, 4> tiles_pos;
-		std::array<Pos, 4> shadow;
-		GLfloat delay;
-		Timer fallTimer;
-		std::unique_ptr<Shader> shad;
-		bool isPlaced;
+	//Engine objects
+	Engine engine;
+	SpscQueue<Engine::InputEvent, 256> inputs;
+	Timer deltaTime{};
+	FixedTimestep timestep;
 
-		//Sound
-		std::vector<irrklang::ISoundSource*> sounds;
-		irrklang::ISoundEngine* sEngine{ irrklang::createIrrKlangDevice() };
+	//Built-in player, its moves go through the same input queue as the keys
+	ThreadPool pool;
+	Bot bot{ pool };
+	bool botPlaying = false;
+	bool botThink = true;	//The tetramino has not been planned yet
 
-		//Inititalization member functions
-		void init_sounds();
-		void init_shader();
-		explicit Tetramino(Field& fd, TetraminoPrototype const&, GLfloat delay = 0.7f);
-		~Tetramino();
-		void update(TetraminoPrototype const&, GLfloat delay);
+	Replay recording;
+	static constexpr const char* RECORDING_PATH = "last_game.replay";
 
-		//Moving
-		void process_input(MovingType);
-		void advancePos(Pos const&);
-		bool move(Pos const&);
-		void moveLeft();
-		void moveRight();
-		void moveDown();
-		void rotate();
-		void fall();
-		void fast();
-		void slow();
-		void updateShadow();
+	//Starts of the last tetraminos, Backspace takes the last placed one back
+	Rewind<Engine, 64> history;
+	bool undo = false;
+	bool rewound = false;	//The recording does not play the game any more
 
-		//Drawing
-		void drawTile(Tile const&, glm::vec2 const& pos) const;
-		void removeFromField() const;
-		bool addToField() const;
+	//Tetramino position before the last tick, it's drawn in between the last two ticks
+	std::array<Engine::Pos, 4> previous_pos{};
+	bool interpolate = false;
 
-		//Help const functions
-		void fillWith(TileColor col) const;
-		bool tileIsAllowed(Pos const&) const;
-		bool canMoveTowards(Pos const&) const;
-		std::array<Pos, 4> getBottom() const;
-	};
-
-	//Engine objects
-	Field field{ NONE };
-	Tetramino tetramino{ field, TetraminoPrototype{} };
-	std::vector<TetraminoPrototype> next_tetraminos;
-	Timer deltaTime{};
-	bool isGame = true;
-	static inline std::mt19937 rd{ std::random_device{}() };
+	//Decoded resources, the textures and the sounds are made straight from it
+	std::unique_ptr<Bundle> assets;
+	std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();	//Reported at the first frame
+	bool presented = false;
 
 	//Sounds
-	irrklang::ISoundEngine* sEngine{ irrklang::createIrrKlangDevice() };
-	std::vector<irrklang::ISoundSource*> sounds;
+	std::unique_ptr<Audio> audio;
+
+	//Drawing
+	std::unique_ptr<Renderer> renderer;
+	std::unique_ptr<GpuTimer> gpuTimer;
 
-	//OpenGL data
-	std::unique_ptr<Shader> shad;
+	//Zones of the last frames when the game is run with --profile, saved on F12 and when the game is left
+	static constexpr const char* PROFILE_PATH = "profile.json";
 
 	//Static functions
 	static void keyboard_callback(GLFWwindow*, int key, int scancode, int action, int mods);
-	static glm::vec3 convert(glm::vec3 const& vec);
+	static void framebuffer_size_callback(GLFWwindow*, int width, int height);
 
 	//Initialization member functions
+	void init_assets();
 	GLFWimage load_icon() const;
 	void init_window();
-	void init_buffers() const;
-	void init_textures() const;
-	void init_shader();
+	void init_renderer();
 	void init_sounds();
-	void init_tetraminos();
-	
-	//Drawable member functions
-	void drawBackground() const;
-	void drawFrame() const;
-	void drawField() const;
-	void drawNextTetraminos() const;
+
 	void render() const;
 
 	//Core member functions
-	void updateTetramino();
-	void updateNextTetraminos();
-	void clearLines();
-	void playSound(SoundType);
-	bool checkForGameOver();
+	void updateEngine();
+	void updateReplay(ReplayPlayer&);
+	void updateBot();
+	void takeBack();
+	void onStep(Engine::Events);
+	void saveRecording();
+	void saveProfile() const;
+	void pollEvents();
+	void playSounds(Engine::Events);
+	void present();
 
 public:
-	Tetris();
+	explicit Tetris(std::uint32_t tickRate = Engine::TICK_RATE);
 	~Tetris();
 	void game();
+	void watch(Replay const&);
+	void spectate(std::uint32_t boards);
 };
 inline Tetris tetris{};
\ No newline at end of file
@@ -0,0 +1,86 @@
+#include "ThreadPool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(std::size_t threads)
+{
+	threads = std::max<std::size_t>(threads, 1);
+	for (std::size_t i = 0; i < threads; ++i)
+		queues.push_back(std::make_unique<Queue>());
+
+	workers.reserve(threads);
+	for (std::size_t i = 0; i < threads; ++i)
+		workers.emplace_back(&ThreadPool::work, this, i);
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard lock(sleepMutex);
+		stopping = true;
+	}
+	wakeUp.notify_all();
+
+	for (auto& worker : workers)
+		worker.join();
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+	auto& queue = *queues[next.fetch_add(1, std::memory_order_relaxed) % queues.size()];
+	{
+		std::lock_guard lock(queue.mutex);
+		queue.tasks.push_back(std::move(task));
+	}
+
+	{
+		std::lock_guard lock(sleepMutex);
+		queued.fetch_add(1, std::memory_order_release);
+	}
+	wakeUp.notify_one();
+}
+
+//Runs one task, first from the own queue and then stolen from the others
+bool ThreadPool::tryRun(std::size_t home)
+{
+	std::function<void()> task;
+	for (std::size_t k = 0; k < queues.size() && !task; ++k)
+	{
+		auto& queue = *queues[(home + k) % queues.size()];
+		std::lock_guard lock(queue.mutex);
+		if (queue.tasks.empty())
+			continue;
+
+		if (k == 0)
+		{
+			task = std::move(queue.tasks.back());
+			queue.tasks.pop_back();
+		}
+		else
+		{
+			task = std::move(queue.tasks.front());
+			queue.tasks.pop_front();
+		}
+	}
+
+	if (!task)
+		return false;
+
+	queued.fetch_sub(1, std::memory_order_relaxed);
+	task();
+	return true;
+}
+
+void ThreadPool::work(std::size_t index)
+{
+	while (true)
+	{
+		if (this->tryRun(index))
+			continue;
+
+		std::unique_lock lock(sleepMutex);
+		wakeUp.wait(lock, [this]() { return stopping || queued.load(std::memory_order_acquire); });
+		if (stopping)
+			return;
+	}
+}
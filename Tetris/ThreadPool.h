@@ -0,0 +1,59 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//Work-stealing thread pool. Every worker has its own queue and takes the newest task from it,
+//idle workers steal the oldest tasks from the others. Threads waiting for their tasks help running them
+class ThreadPool
+{
+	struct Queue {
+		std::mutex mutex;
+		std::deque<std::function<void()>> tasks;
+	};
+
+	std::vector<std::unique_ptr<Queue>> queues;
+	std::vector<std::thread> workers;
+	std::atomic<std::size_t> next{ 0 };
+	std::atomic<std::size_t> queued{ 0 };
+	std::mutex sleepMutex;
+	std::condition_variable wakeUp;
+	bool stopping = false;
+
+	bool tryRun(std::size_t home);
+	void work(std::size_t index);
+
+public:
+	explicit ThreadPool(std::size_t threads = std::thread::hardware_concurrency());
+	~ThreadPool();
+
+	ThreadPool(ThreadPool const&) = delete;
+	ThreadPool& operator=(ThreadPool const&) = delete;
+
+	void submit(std::function<void()> task);
+
+	//Runs f(0) ... f(count - 1) on the pool and returns when all of them are done
+	template<class F>
+	void parallelFor(std::size_t count, F&& f)
+	{
+		std::atomic<std::size_t> left{ count };
+		for (std::size_t i = 0; i < count; ++i)
+			this->submit([&f, &left, i]() {
+				f(i);
+				left.fetch_sub(1, std::memory_order_release);
+				}
+			);
+
+		while (left.load(std::memory_order_acquire))
+			if (!this->tryRun(next.load(std::memory_order_relaxed)))
+				std::this_thread::yield();
+	}
+
+	std::size_t size() const { return workers.size(); }
+};
@@ -0,0 +1,113 @@
+#pragma once
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstddef>
+
+#include "GlState.hpp"
+#include "RenderStats.hpp"
+
+//Collects the tiles of a frame and draws all of them with a single instanced call.
+//Per-tile data is streamed into its own vertex buffer, the quad itself is shared with the other draws
+class TileBatch
+{
+public:
+	struct Instance {
+		GLfloat x;
+		GLfloat y;				//Top-left corner in the unscaled window pixels
+		GLubyte color;
+		GLubyte transparency;	//Normalized to [0, 1] by the vertex fetch
+		GLubyte padding[2];
+	};
+
+	//The tetramino with its shadow and the next tetraminos fit into it, the locked tiles are kept by FieldLayer
+	static constexpr GLsizei MAX_INSTANCES = 64;
+
+private:
+	GLuint VAO;
+	GLuint instanceVBO;
+	std::array<Instance, MAX_INSTANCES> instances;
+	GLsizei count = 0;
+
+public:
+	//Binds the quad and the per-tile attributes to a new vertex array.
+	//The quad buffer has to have the layout set by Tetris::init_buffers, the instance buffer holds Instance
+	static GLuint createVertexArray(GLuint quadVBO, GLuint instanceVBO)
+	{
+		GLuint VAO;
+		glGenVertexArrays(1, &VAO);
+		glState.bindVertexArray(VAO);
+
+		glState.bindBuffer(GL_ARRAY_BUFFER, quadVBO);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(GLfloat), nullptr);
+		glEnableVertexAttribArray(0);
+
+		glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(GLfloat), (void*)(3 * sizeof(GLfloat)));
+		glEnableVertexAttribArray(1);
+
+		//Instance attributes advance once per tile
+		glState.bindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+		glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, sizeof(Instance), (void*)offsetof(Instance, x));
+		glEnableVertexAttribArray(3);
+		glVertexAttribDivisor(3, 1);
+
+		glVertexAttribIPointer(4, 1, GL_UNSIGNED_BYTE, sizeof(Instance), (void*)offsetof(Instance, color));
+		glEnableVertexAttribArray(4);
+		glVertexAttribDivisor(4, 1);
+
+		glVertexAttribPointer(5, 1, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Instance), (void*)offsetof(Instance, transparency));
+		glEnableVertexAttribArray(5);
+		glVertexAttribDivisor(5, 1);
+		return VAO;
+	}
+
+	explicit TileBatch(GLuint quadVBO)
+	{
+		glGenBuffers(1, &instanceVBO);
+		glState.bindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(instances), nullptr, GL_STREAM_DRAW);
+		VAO = createVertexArray(quadVBO, instanceVBO);
+	}
+
+	~TileBatch()
+	{
+		glState.deleteBuffer(instanceVBO);
+		glState.deleteVertexArray(VAO);
+	}
+
+	TileBatch(TileBatch const&) = delete;
+	TileBatch& operator=(TileBatch const&) = delete;
+
+	void clear()
+	{
+		count = 0;
+	}
+
+	void push(glm::vec2 const& pos, GLuint color, GLfloat transparency)
+	{
+		if (count == MAX_INSTANCES)
+			return;
+
+		instances[count++] = { pos.x, pos.y, (GLubyte)color, (GLubyte)(transparency * 255.f + 0.5f), {} };
+	}
+
+	//The tile shader has to be in use
+	void draw() const
+	{
+		if (!count)
+			return;
+
+		renderStats.bytesUploaded += count * sizeof(Instance);
+		++renderStats.drawCalls;
+
+		glState.bindVertexArray(VAO);
+
+		//Orphan the previous frame's storage so the upload does not wait for the GPU
+		glState.bindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(instances), nullptr, GL_STREAM_DRAW);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(Instance), instances.data());
+
+		glDrawArraysInstanced(GL_TRIANGLES, 0, 6, count);
+	}
+};
@@ -3,12 +3,12 @@
 
 struct Timer
 {
-	GLfloat currTime = 0;
-	GLfloat lastTime = 0;
+	double currTime = 0;
+	double lastTime = 0;
 
 	void start() { lastTime = currTime; }
 
-	void stop() { currTime = (GLfloat)glfwGetTime(); }
+	void stop() { currTime = glfwGetTime(); }
 
-	GLfloat getElapsedTime() const { return currTime - lastTime; }
+	double getElapsedTime() const { return currTime - lastTime; }
 };
@@ -0,0 +1,45 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 xTextrCoord;
+
+//Layer of a board, a cell is the color of its tile and the shadow bit
+uniform usampler2DArray cells;
+//Layer of a tile is its color
+uniform sampler2DArray tiles;
+
+uniform vec2 boardSize;		//In cells
+uniform vec2 gridOrigin;	//Top-left corner of the grid in the texture coordinates of the window
+uniform vec2 cellSize;		//In the texture coordinates of the window
+uniform int columns;		//Boards in a row of the grid
+uniform int boards;
+
+const float GAP = 1.0;		//Cells between the boards
+const uint SHADOW = 16u;
+
+void main()
+{
+	//Cells from the top-left corner of the grid
+	vec2 pos = vec2(xTextrCoord.x - gridOrigin.x, gridOrigin.y - xTextrCoord.y) / cellSize;
+	vec2 slot = boardSize + GAP;
+	ivec2 index = ivec2(floor(pos / slot));
+	vec2 local = pos - vec2(index) * slot;
+	int board = index.y * columns + index.x;
+	if (pos.x < 0.0 || pos.y < 0.0 || index.x >= columns || board >= boards || local.x >= boardSize.x || local.y >= boardSize.y)
+		discard;
+
+	//A free cell is the glass of the field
+	uint cell = texelFetch(cells, ivec3(ivec2(local), board), 0).r;
+	if (cell == 0u)
+	{
+		FragColor = vec4(0.0, 0.0, 0.0, 0.4);
+		return;
+	}
+
+	//The tile texture goes up, the gradients are taken before the wrap so the mipmap is the same across the cell edges
+	vec2 tileCoord = vec2(fract(local.x), 1.0 - fract(local.y));
+	vec2 dx = dFdx(local) * vec2(1.0, -1.0);
+	vec2 dy = dFdy(local) * vec2(1.0, -1.0);
+	vec4 textr = textureGrad(tiles, vec3(tileCoord, float(cell & ~SHADOW)), dx, dy);
+	FragColor = vec4(textr.xyz, (cell & SHADOW) != 0u ? textr.w * 0.5 : textr.w);
+}
\ No newline at end of file
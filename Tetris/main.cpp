@@ -1,9 +1,34 @@
 #define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
 #include "Tetris.h"
 
-int main()
+#include <cstring>
+
+int main(int argc, char* argv[])
 {
-	tetris.game();
+	//"--profile" before the other arguments records the frame zones
+	if (argc > 1 && !std::strcmp(argv[1], "--profile"))
+	{
+		Profiler::setEnabled(true);
+		--argc;
+		++argv;
+	}
+
+	//"--spectate N" shows N games of the bot at once
+	if (argc > 2 && !std::strcmp(argv[1], "--spectate"))
+		tetris.spectate(std::max((std::uint32_t)std::strtoul(argv[2], nullptr, 10), 1u));
+	//A replay file given as the argument is watched instead of playing
+	else if (argc > 1)
+	{
+		auto replay = Replay::load(argv[1]);
+		if (!replay)
+		{
+			std::cerr << "Failed to load the replay " << argv[1] << std::endl;
+			return EXIT_FAILURE;
+		}
+		tetris.watch(*replay);
+	}
+	else tetris.game();
 
 	return EXIT_SUCCESS;
 }
\ No newline at end of file
@@ -1,16 +1,15 @@
 #version 330 core
 out vec4 FragColor;
 
-in vec2 xTileCoord;
+in vec2 xTextrCoord;
+flat in uint xTileColor;
+in float xTransparency;
 
-const float tileSide = 0.125f;
-
-uniform sampler2D texture1;
-uniform uint tileColor;
-uniform float transparency;
+//Layer of a tile is its color
+uniform sampler2DArray texture1;
 
 void main()
 {
-	vec4 textr = texture(texture1, vec2(xTileCoord.x + tileSide * tileColor, xTileCoord.y)); 
-	FragColor = vec4(textr.xyz, textr.w * (1 - transparency));
+	vec4 textr = texture(texture1, vec3(xTextrCoord, xTileColor));
+	FragColor = vec4(textr.xyz, textr.w * (1 - xTransparency));
 }
\ No newline at end of file
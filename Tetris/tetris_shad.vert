@@ -1,16 +1,38 @@
 #version 330 core
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec2 aTextrCoord;
-layout (location = 2) in vec2 aTileCoord;
+
+//Per-tile attributes of the instanced draw
+layout (location = 3) in vec2 aTilePos;
+layout (location = 4) in uint aTileColor;
+layout (location = 5) in float aTransparency;
 
 out vec2 xTextrCoord;
-out vec2 xTileCoord;
+flat out uint xTileColor;
+out float xTransparency;
+
+//Shared by all the programs, see Renderer::FrameBlock
+layout (std140) uniform Frame
+{
+	mat4 projection;	//Unscaled window pixels to clip space
+	vec2 scale;
+	float tileSize;
+};
 
-uniform mat4 model;
+uniform bool instanced;
 
 void main()
 {
-	gl_Position = model * vec4(aPos, 1.0);
+	if (instanced)
+	{
+		//Free cells of the field layer collapse into a point outside of the view and produce no fragments
+		vec2 corner = aTilePos + tileSize * vec2(aPos.x + 0.5, 0.5 - aPos.y);
+		gl_Position = aTileColor == 0u ? vec4(2.0, 2.0, 2.0, 1.0) : projection * vec4(corner, 0.0, 1.0);
+	}
+	else
+		gl_Position = vec4(aPos.xy * scale, aPos.z, 1.0);
+
 	xTextrCoord = aTextrCoord;
-	xTileCoord = aTileCoord;
+	xTileColor = aTileColor;
+	xTransparency = aTransparency;
 }
\ No newline at end of file